@@ -19,12 +19,17 @@
 #include "ha/esp_zigbee_ha_standard.h"
 #include "esp_zb_hvac.h"
 #include "hvac_driver.h"
+#include "hvac_latency.h"
+#include "hvac_boot_profile.h"
 #include "esp_zb_ota.h"
 #include "esp_zigbee_trace.h"
+#include "zboss_api.h"
 #include "sdkconfig.h"
 #include "esp_ota_ops.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "freertos/timers.h"
+#include <stdatomic.h>
 
 
 #if !defined ZB_ROUTER_ROLE
@@ -36,6 +41,11 @@ static const char *TAG = "HVAC_ZIGBEE";
 /* Keepalive interval - required to maintain UART connection with AC unit */
 #define HVAC_KEEPALIVE_INTERVAL_MS  30000  // 30 seconds
 
+/* Adaptive status polling: a burst of HVAC_POLL_BURST_COUNT polls at the
+ * minimum interval after a change, then doubling up to the ceiling */
+#define HVAC_POLL_BURST_COUNT       3
+#define HVAC_POLL_ACTIVE_MAX_S      60     // Ceiling while the unit is on (keeps ambient fresh)
+
 /* Boot button configuration for factory reset */
 #define BOOT_BUTTON_GPIO            GPIO_NUM_9
 #define BUTTON_LONG_PRESS_TIME_MS   5000
@@ -43,7 +53,91 @@ static const char *TAG = "HVAC_ZIGBEE";
 /********************* Function Declarations **************************/
 static esp_err_t deferred_driver_init(void);
 static void hvac_update_zigbee_attributes(uint8_t param);
+static void hvac_update_latency_attribute(void);
+static void hvac_update_boot_profile_attribute(void);
+static void hvac_update_config_attributes(void);
+static esp_err_t hvac_config_attribute_handler(const esp_zb_zcl_set_attr_value_message_t *message);
+
+/* LocalTemperature reporting configuration (persisted in NVS) */
+typedef struct {
+    uint16_t min_interval_s;
+    uint16_t max_interval_s;
+    uint16_t change_cd;
+} hvac_temp_reporting_t;
+
+static const char *ZB_NVS_NAMESPACE = "zb_reporting";  // Zigbee-layer settings (reporting and polling)
+static hvac_temp_reporting_t temp_reporting = {
+    .min_interval_s = HVAC_TEMP_REPORT_MIN_S_DEFAULT,
+    .max_interval_s = HVAC_TEMP_REPORT_MAX_S_DEFAULT,
+    .change_cd = HVAC_TEMP_REPORT_CHANGE_CD_DEFAULT,
+};
+static void hvac_load_zb_settings(void);
+
+/* Adaptive status polling: own task, kicked by task notification so the UART
+ * callback never needs the Zigbee lock (config written by the Zigbee task) */
+typedef struct {
+    uint16_t min_s;
+    uint16_t max_s;
+} hvac_poll_config_t;
+
+static hvac_poll_config_t poll_config = {
+    .min_s = HVAC_POLL_MIN_S_DEFAULT,
+    .max_s = HVAC_POLL_MAX_S_DEFAULT,
+};
+static TaskHandle_t poll_task_handle = NULL;
+
+/* Thermostat read cache (refresh-ahead, Zigbee task only): LocalTemperature
+ * and RunningMode reads are always answered from the attribute table; an
+ * old table triggers a background status refresh for the next read */
+typedef struct {
+    uint16_t max_age_s;     // Refresh when the last status is older (0 = never)
+    uint16_t wait_ms;       // Deadline for the AC to answer a refresh before it counts as stale
+} hvac_cache_config_t;
+
+static hvac_cache_config_t cache_config = {
+    .max_age_s = HVAC_CACHE_MAX_AGE_S_DEFAULT,
+    .wait_ms = HVAC_CACHE_WAIT_MS_DEFAULT,
+};
+static uint32_t cache_hits = 0;
+static uint32_t cache_misses = 0;
+static uint32_t cache_stale = 0;
+static bool cache_refresh_pending = false;
+static int64_t cache_refresh_us = 0;    // When the pending refresh was requested
+static void hvac_apply_temp_reporting(void);
+
+/* HVAC_DIRTY_* bits not yet pushed to Zigbee attributes (set by the RX task) */
+static atomic_uint zb_pending_dirty;
+#define HVAC_ZB_UPDATE_ALL          1   // hvac_update_zigbee_attributes() param: ignore the mask
+
+/* At most one attribute refresh in flight; requests arriving meanwhile only extend the mask.
+ * The RX task never waits for the Zigbee lock: when it is held, one retry timer
+ * tries again shortly (zb_refresh_pending stays set until the refresh runs). */
+static atomic_bool zb_refresh_pending;
+static atomic_uint zb_refresh_requested;
+static atomic_uint zb_refresh_executed;
+static TimerHandle_t zb_refresh_retry_timer = NULL;
+#define HVAC_ZB_REFRESH_RETRY_MS    20  // Delay before retrying a refresh that found the lock held
+
+/* Boot-time refresh: the first status frame validates the UART link for OTA */
+#define HVAC_BOOT_REFRESH_TIMEOUT_MS    1000
+#define HVAC_BOOT_REFRESH_ATTEMPTS      3
+static bool hvac_link_validated = false;
+
+/* Boot: the HVAC driver initializes in its own task while the stack starts */
+typedef enum {
+    HVAC_DRIVER_PENDING = 0,
+    HVAC_DRIVER_READY,
+    HVAC_DRIVER_FAILED,
+} hvac_driver_state_t;
+static hvac_driver_state_t hvac_driver_state = HVAC_DRIVER_PENDING;  // Zigbee lock held
+static bool zb_stack_ready = false;                                  // Zigbee lock held
+static bool zb_network_up = false;
+static void hvac_driver_init_task(void *arg);
+static void hvac_attach_driver(void);
+static void hvac_network_up(void);
 static void hvac_keepalive_task(uint8_t param);
+static void hvac_poll_task(void *arg);
+static void hvac_poll_kick(void);
 static esp_err_t button_init(void);
 static void button_task(void *arg);
 static void factory_reset_device(uint8_t param);
@@ -202,12 +296,138 @@ static esp_err_t button_init(void)
     return ESP_OK;
 }
 
+/* Re-arm the refresh retry; without a timer the keepalive flushes the mask */
+static void hvac_zb_refresh_retry(void)
+{
+    if (zb_refresh_retry_timer == NULL || xTimerStart(zb_refresh_retry_timer, 0) != pdPASS) {
+        atomic_store(&zb_refresh_pending, false);
+        ESP_LOGW(TAG, "Zigbee lock busy, attribute refresh deferred (dirty=0x%06X)",
+                 atomic_load(&zb_pending_dirty));
+    }
+}
+
+/* Timer service task: hand the refresh to the Zigbee task as soon as the
+ * lock is free (the alarm can only be armed with the lock held) */
+static void zb_refresh_retry_callback(TimerHandle_t timer)
+{
+    if (esp_zb_lock_acquire(0)) {
+        esp_zb_scheduler_alarm((esp_zb_callback_t)hvac_update_zigbee_attributes, 0, 0);
+        esp_zb_lock_release();
+    } else {
+        hvac_zb_refresh_retry();
+    }
+}
+
 /* Callback function for UART state changes - triggers immediate Zigbee update */
-static void hvac_uart_state_changed_callback(void)
+static void hvac_uart_state_changed_callback(uint32_t changed)
+{
+    /* A command or an IR-remote change: poll closely for the next few seconds */
+    if (changed & HVAC_SHADOW_FIELDS) {
+        hvac_poll_kick();
+    }
+    
+    /* Accumulate the changed fields; the update consumes the whole mask, so
+     * several frames decoded before it runs are folded into one pass */
+    atomic_fetch_or(&zb_pending_dirty, changed);
+    atomic_fetch_add_explicit(&zb_refresh_requested, 1, memory_order_relaxed);
+    
+    if (atomic_exchange(&zb_refresh_pending, true)) {
+        return;  // The refresh in flight has not consumed the mask yet
+    }
+    
+    /* Refresh right away from the RX task instead of after a scheduler delay,
+     * but never wait for the lock there */
+    if (esp_zb_lock_acquire(0)) {
+        hvac_update_zigbee_attributes(0);
+        esp_zb_lock_release();
+    } else {
+        hvac_zb_refresh_retry();
+    }
+}
+
+/* Runs hvac_driver_init() next to the Zigbee stack start instead of after it:
+ * UART setup, NVS/journal load and the boot status exchange with the AC take
+ * a good part of a second and do not need the stack. */
+static void hvac_driver_init_task(void *arg)
+{
+    ESP_LOGI(TAG, "[INIT] Initializing HVAC UART driver...");
+    esp_err_t ret = hvac_driver_init();
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "[ERROR] Failed to initialize HVAC driver: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "[WARN] Continuing without HVAC - endpoints will still be created");
+        // Don't fail - we can still expose Zigbee endpoints without HVAC connected
+    } else {
+        ESP_LOGI(TAG, "[OK] HVAC driver initialized successfully");
+        hvac_boot_mark(HVAC_BOOT_DRIVER_READY);
+        
+        /* Wait for the AC to answer instead of assuming the UART link works:
+         * a status frame proves the new firmware can talk to the unit. Boot
+         * reconciliation in hvac_driver_init() has usually got one already. */
+        esp_err_t refresh_ret = hvac_get_status_age_ms() != UINT32_MAX ? ESP_OK : ESP_ERR_TIMEOUT;
+        for (int attempt = 0; attempt < HVAC_BOOT_REFRESH_ATTEMPTS && refresh_ret != ESP_OK; attempt++) {
+            refresh_ret = hvac_refresh_state(HVAC_BOOT_REFRESH_TIMEOUT_MS);
+        }
+        if (refresh_ret != ESP_OK) {
+            ESP_LOGW(TAG, "[WARN] No status from AC (%s) - hardware not validated yet",
+                     esp_err_to_name(refresh_ret));
+        }
+    }
+    
+    /* Hand over to the Zigbee side; whichever of this task and the stack
+     * start finishes last attaches the driver */
+    esp_zb_lock_acquire(portMAX_DELAY);
+    hvac_driver_state = (ret == ESP_OK) ? HVAC_DRIVER_READY : HVAC_DRIVER_FAILED;
+    if (zb_stack_ready) {
+        hvac_attach_driver();
+    }
+    esp_zb_lock_release();
+    
+    vTaskDelete(NULL);
+}
+
+/* Connect the initialized driver to the Zigbee attributes (Zigbee lock held) */
+static void hvac_attach_driver(void)
 {
-    /* Schedule immediate Zigbee attribute update (runs in Zigbee task context)
-     * This ensures physical remote changes are reflected instantly */
-    esp_zb_scheduler_alarm((esp_zb_callback_t)hvac_update_zigbee_attributes, 0, 100);
+    static bool attached = false;
+    if (attached || hvac_driver_state == HVAC_DRIVER_PENDING) {
+        return;
+    }
+    attached = true;
+    
+    if (hvac_driver_state != HVAC_DRIVER_READY) {
+        return;
+    }
+    
+    /* Register callback for instant state change notifications from UART */
+    ESP_LOGI(TAG, "[INIT] Registering UART state change callback...");
+    zb_refresh_retry_timer = xTimerCreate("zb_refresh", pdMS_TO_TICKS(HVAC_ZB_REFRESH_RETRY_MS),
+                                          pdFALSE, NULL, zb_refresh_retry_callback);
+    if (zb_refresh_retry_timer == NULL) {
+        ESP_LOGW(TAG, "[WARN] No attribute refresh retry timer - busy-lock refreshes wait for the keepalive");
+    }
+    hvac_register_state_change_callback(hvac_uart_state_changed_callback);
+    ESP_LOGI(TAG, "[OK] UART state change callback registered - physical remote changes will be instant");
+    
+    /* Status poll task: idle until the first kick (network up) */
+    if (xTaskCreate(hvac_poll_task, "hvac_poll", 2560, NULL, 5, &poll_task_handle) != pdPASS) {
+        ESP_LOGE(TAG, "[ERROR] Failed to create status poll task");
+    }
+    
+    /* Ambient filter settings come from the driver's NVS namespace */
+    hvac_update_config_attributes();
+    
+    if (hvac_get_status_age_ms() != UINT32_MAX) {
+        ESP_LOGI(TAG, "[OK] AC answered status request");
+        hvac_update_zigbee_attributes(HVAC_ZB_UPDATE_ALL);
+        hvac_link_validated = true;
+        ota_validation_hw_init_ok();
+    }
+    
+    /* Network came up before the driver: start polling now */
+    if (zb_network_up) {
+        hvac_poll_kick();
+    }
 }
 
 static esp_err_t deferred_driver_init(void)
@@ -223,32 +443,35 @@ static esp_err_t deferred_driver_init(void)
     }
     ESP_LOGI(TAG, "[INIT] Boot button initialization complete");
     
-    /* Small delay to ensure logs are flushed */
-    vTaskDelay(pdMS_TO_TICKS(10));
+    /* The HVAC driver has been initializing in parallel since esp_zb_init() */
+    zb_stack_ready = true;
+    hvac_attach_driver();
     
-    /* Initialize HVAC UART driver */
-    ESP_LOGI(TAG, "[INIT] Initializing HVAC UART driver...");
-    ESP_LOGI(TAG, "[INIT] About to call hvac_driver_init()");
-    esp_err_t ret = ESP_OK;
+    ESP_LOGI(TAG, "[INIT] Deferred initialization complete");
+    return ESP_OK;
+}
+
+/* Joined or rejoined: start the periodic tasks and report the AC state now
+ * rather than after a fixed delay */
+static void hvac_network_up(void)
+{
+    zb_network_up = true;
+    hvac_boot_mark(HVAC_BOOT_NETWORK_UP);
     
-    // Wrap HVAC init in try-catch equivalent to prevent crashes
-    ret = hvac_driver_init();
+    /* Keepalive every 30s to maintain the UART connection (restarted, not stacked, on rejoin) */
+    esp_zb_scheduler_alarm_cancel((esp_zb_callback_t)hvac_keepalive_task, 0);
+    esp_zb_scheduler_alarm((esp_zb_callback_t)hvac_keepalive_task, 0, HVAC_KEEPALIVE_INTERVAL_MS);
     
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "[ERROR] Failed to initialize HVAC driver: %s", esp_err_to_name(ret));
-        ESP_LOGW(TAG, "[WARN] Continuing without HVAC - endpoints will still be created");
-        // Don't fail - we can still expose Zigbee endpoints without HVAC connected
-    } else {
-        ESP_LOGI(TAG, "[OK] HVAC driver initialized successfully");
-        
-        /* Register callback for instant state change notifications from UART */
-        ESP_LOGI(TAG, "[INIT] Registering UART state change callback...");
-        hvac_register_state_change_callback(hvac_uart_state_changed_callback);
-        ESP_LOGI(TAG, "[OK] UART state change callback registered - physical remote changes will be instant");
+    if (hvac_driver_state != HVAC_DRIVER_READY) {
+        return;  // hvac_attach_driver() pushes the attributes once the driver is up
     }
     
-    ESP_LOGI(TAG, "[INIT] Deferred initialization complete");
-    return ESP_OK;
+    /* Poll right away, then keep polling with a burst */
+    hvac_request_status();
+    hvac_poll_kick();
+    
+    /* State from boot reconciliation is current: push it without waiting for the poll */
+    hvac_update_zigbee_attributes(HVAC_ZB_UPDATE_ALL);
 }
 
 static void bdb_start_top_level_commissioning_cb(uint8_t mode_mask)
@@ -303,6 +526,7 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
                 ESP_LOGI(TAG, "[JOIN] IEEE Address: %02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x",
                          ieee_addr[7], ieee_addr[6], ieee_addr[5], ieee_addr[4],
                          ieee_addr[3], ieee_addr[2], ieee_addr[1], ieee_addr[0]);
+                hvac_network_up();
             }
         } else {
             ESP_LOGW(TAG, "[JOIN] Failed to initialize Zigbee stack (status: %s)", 
@@ -378,12 +602,7 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
             ota_validation_zigbee_connected();
             
             ESP_LOGI(TAG, "[JOIN] Starting keepalive task and requesting initial state...");
-            
-            /* Request initial status to populate Zigbee attributes */
-            hvac_request_status();
-            
-            /* Start keepalive task (sends keepalive every 30s to maintain UART connection) */
-            esp_zb_scheduler_alarm((esp_zb_callback_t)hvac_keepalive_task, 0, 5000);
+            hvac_network_up();
             ESP_LOGI(TAG, "[JOIN] Setup complete!");
         } else {
             ESP_LOGW(TAG, "[JOIN] Network steering failed (status: %s)", 
@@ -411,10 +630,21 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
     }
 }
 
+/* Hand a change set to the HVAC command task; never blocks the Zigbee task */
+static void hvac_submit(const hvac_state_delta_t *delta, const char *what)
+{
+    esp_err_t err = hvac_apply_async(delta);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "%s change not queued: %s", what, esp_err_to_name(err));
+    }
+}
+
 static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t *message)
 {
     esp_err_t ret = ESP_OK;
     
+    hvac_latency_mark(HVAC_LAT_HANDLER);
+    
     ESP_RETURN_ON_FALSE(message, ESP_FAIL, TAG, "Empty message");
     ESP_RETURN_ON_FALSE(message->info.status == ESP_ZB_ZCL_STATUS_SUCCESS, ESP_ERR_INVALID_ARG, 
                        TAG, "Received message: error status(%d)", message->info.status);
@@ -434,8 +664,7 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
             case ESP_ZB_ZCL_ATTR_THERMOSTAT_OCCUPIED_COOLING_SETPOINT_ID:
                 if (message->attribute.data.type == ESP_ZB_ZCL_ATTR_TYPE_S16) {
                     int16_t temp_setpoint = *(int16_t *)message->attribute.data.value;
-                    uint8_t temp_c = (uint8_t)(temp_setpoint / 100);
-                    ESP_LOGI(TAG, "Temperature setpoint write request: %d°C", temp_c);
+                    ESP_LOGI(TAG, "Temperature setpoint write request: %d centidegrees", temp_setpoint);
                     
                     // Update heating setpoint immediately (we only use heating setpoint for control)
                     esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
@@ -444,10 +673,9 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
                                                  &temp_setpoint, true);
                     
                     // Send command to AC (UART callback will update again when AC confirms)
-                    esp_err_t err = hvac_set_temperature(temp_c);
-                    if (err != ESP_OK) {
-                        ESP_LOGW(TAG, "hvac_set_temperature(%d) failed: %s", temp_c, esp_err_to_name(err));
-                    }
+                    // ZCL centidegrees go straight through; the driver rounds to whole degrees
+                    hvac_state_delta_t delta = { .fields = HVAC_FIELD_TEMP, .target_temp_cd = temp_setpoint };
+                    hvac_submit(&delta, "setpoint");
                 }
                 break;
                 
@@ -482,21 +710,21 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
                                                  &running_mode, false);
                     
                     // Map Zigbee system mode to HVAC mode and send command to AC
-                    hvac_mode_t hvac_mode = HVAC_MODE_OFF;
-                    esp_err_t mode_err = ESP_OK;
+                    hvac_state_delta_t delta = { .fields = HVAC_FIELD_MODE };
                     switch (system_mode) {
-                        case 0x00: hvac_mode = HVAC_MODE_OFF; mode_err = hvac_set_power(false); break;
-                        case 0x01: hvac_mode = HVAC_MODE_AUTO; mode_err = hvac_set_mode(hvac_mode); break;
-                        case 0x03: hvac_mode = HVAC_MODE_COOL; mode_err = hvac_set_mode(hvac_mode); break;
-                        case 0x04: hvac_mode = HVAC_MODE_HEAT; mode_err = hvac_set_mode(hvac_mode); break;
-                        case 0x07: hvac_mode = HVAC_MODE_FAN; mode_err = hvac_set_mode(hvac_mode); break;
-                        case 0x08: hvac_mode = HVAC_MODE_DRY; mode_err = hvac_set_mode(hvac_mode); break;
+                        case 0x00: delta = (hvac_state_delta_t){ .fields = HVAC_FIELD_POWER, .power_on = false }; break;
+                        case 0x01: delta.mode = HVAC_MODE_AUTO; break;
+                        case 0x03: delta.mode = HVAC_MODE_COOL; break;
+                        case 0x04: delta.mode = HVAC_MODE_HEAT; break;
+                        case 0x07: delta.mode = HVAC_MODE_FAN; break;
+                        case 0x08: delta.mode = HVAC_MODE_DRY; break;
                         default:
                             ESP_LOGW(TAG, "Unsupported system mode: %d", system_mode);
+                            delta.fields = 0;
                             break;
                     }
-                    if (mode_err != ESP_OK) {
-                        ESP_LOGW(TAG, "hvac_set_mode/power(%d) failed: %s", system_mode, esp_err_to_name(mode_err));
+                    if (delta.fields) {
+                        hvac_submit(&delta, "system mode");
                     }
                     // UART callback will update again when AC confirms
                 }
@@ -518,13 +746,11 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
                                              &fan_mode, false);
                 
                 // Send command to AC (UART callback will update again when AC confirms)
-                hvac_fan_t hvac_fan = (hvac_fan_t)fan_mode;
-                ESP_LOGI(TAG, "Setting HVAC fan to: 0x%02X", hvac_fan);
-                esp_err_t fan_err = hvac_set_fan_speed(hvac_fan);
-                if (fan_err != ESP_OK) {
-                    ESP_LOGW(TAG, "hvac_set_fan_speed(0x%02X) failed: %s", hvac_fan, esp_err_to_name(fan_err));
-                }
+                hvac_state_delta_t delta = { .fields = HVAC_FIELD_FAN, .fan_speed = (hvac_fan_t)fan_mode };
+                hvac_submit(&delta, "fan mode");
             }
+        } else if (message->info.cluster == HVAC_CONFIG_CLUSTER_ID) {
+            ret = hvac_config_attribute_handler(message);
         }
     }
     /* Handle Eco Mode Switch - Endpoint 2 */
@@ -533,10 +759,8 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
             if (message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID) {
                 bool on_off = *(bool *)message->attribute.data.value;
                 ESP_LOGI(TAG, "[ECO] Mode %s (sending to AC, will update when AC responds)", on_off ? "ON" : "OFF");
-                esp_err_t eco_err = hvac_set_eco_mode(on_off);
-                if (eco_err != ESP_OK) {
-                    ESP_LOGW(TAG, "hvac_set_eco_mode(%d) failed: %s", on_off, esp_err_to_name(eco_err));
-                }
+                hvac_state_delta_t delta = { .fields = HVAC_FIELD_ECO, .eco_mode = on_off };
+                hvac_submit(&delta, "eco");
                 /* Don't schedule update - UART callback will handle it when AC responds */
             }
         }
@@ -547,7 +771,8 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
             if (message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID) {
                 bool on_off = *(bool *)message->attribute.data.value;
                 ESP_LOGI(TAG, "[SWING] Mode %s (sending to AC, will update when AC responds)", on_off ? "ON" : "OFF");
-                hvac_set_swing(on_off);
+                hvac_state_delta_t delta = { .fields = HVAC_FIELD_SWING, .swing_on = on_off };
+                hvac_submit(&delta, "swing");
                 /* Don't schedule update - UART callback will handle it when AC responds */
             }
         }
@@ -558,7 +783,8 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
             if (message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID) {
                 bool on_off = *(bool *)message->attribute.data.value;
                 ESP_LOGI(TAG, "[DISPLAY] %s (sending to AC, will update when AC responds)", on_off ? "ON" : "OFF");
-                hvac_set_display(on_off);
+                hvac_state_delta_t delta = { .fields = HVAC_FIELD_DISPLAY, .display_on = on_off };
+                hvac_submit(&delta, "display");
                 /* Don't schedule update - UART callback will handle it when AC responds */
             }
         }
@@ -569,7 +795,8 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
             if (message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID) {
                 bool on_off = *(bool *)message->attribute.data.value;
                 ESP_LOGI(TAG, "[NIGHT] Mode %s (sending to AC, will update when AC responds)", on_off ? "ON" : "OFF");
-                hvac_set_night_mode(on_off);
+                hvac_state_delta_t delta = { .fields = HVAC_FIELD_NIGHT, .night_mode = on_off };
+                hvac_submit(&delta, "night");
                 /* Don't schedule update - UART callback will handle it when AC responds */
             }
         }
@@ -580,7 +807,8 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
             if (message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID) {
                 bool on_off = *(bool *)message->attribute.data.value;
                 ESP_LOGI(TAG, "[PURIFIER] %s (sending to AC, will update when AC responds)", on_off ? "ON" : "OFF");
-                hvac_set_purifier(on_off);
+                hvac_state_delta_t delta = { .fields = HVAC_FIELD_PURIFIER, .purifier_on = on_off };
+                hvac_submit(&delta, "purifier");
                 /* Don't schedule update - UART callback will handle it when AC responds */
             }
         }
@@ -596,7 +824,8 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
             if (message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID) {
                 bool on_off = *(bool *)message->attribute.data.value;
                 ESP_LOGI(TAG, "[MUTE] %s (sending to AC, will update when AC responds)", on_off ? "ON" : "OFF");
-                hvac_set_mute(on_off);
+                hvac_state_delta_t delta = { .fields = HVAC_FIELD_MUTE, .mute_on = on_off };
+                hvac_submit(&delta, "mute");
                 /* Don't schedule update - UART callback will handle it when AC responds */
             }
         }
@@ -605,14 +834,114 @@ static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t
     return ret;
 }
 
+/* Settle the background refresh in flight: answered, or stale past the deadline */
+static void hvac_cache_refresh_check(void)
+{
+    if (!cache_refresh_pending) {
+        return;
+    }
+    
+    uint32_t since_ms = (uint32_t)((esp_timer_get_time() - cache_refresh_us) / 1000);
+    if (hvac_get_status_age_ms() < since_ms) {
+        cache_refresh_pending = false;   // A status frame arrived after the request
+    } else if (since_ms > cache_config.wait_ms) {
+        cache_refresh_pending = false;
+        cache_stale++;
+        ESP_LOGW(TAG, "[CACHE] AC did not answer the refresh within %u ms", cache_config.wait_ms);
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     HVAC_DIAG_ATTR_CACHE_STALE_ID,
+                                     &cache_stale, false);
+    }
+}
+
+/* A thermostat read is answered from the attribute table right away. When
+ * the last status frame is older than the bound, a status request is queued;
+ * the answer updates the attributes (and reports) through the normal
+ * state-change path. Never blocks the Zigbee task. */
+static void hvac_cache_on_read(void)
+{
+    hvac_cache_refresh_check();
+    
+    uint32_t age_ms = hvac_get_status_age_ms();
+    if (cache_config.max_age_s == 0 || age_ms <= (uint32_t)cache_config.max_age_s * 1000) {
+        cache_hits++;
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     HVAC_DIAG_ATTR_CACHE_HITS_ID,
+                                     &cache_hits, false);
+        return;
+    }
+    
+    cache_misses++;
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_DIAG_ATTR_CACHE_MISSES_ID,
+                                 &cache_misses, false);
+    
+    /* One refresh at a time: a burst of reads shares it */
+    if (!cache_refresh_pending && hvac_request_status() == ESP_OK) {
+        cache_refresh_pending = true;
+        cache_refresh_us = esp_timer_get_time();
+        ESP_LOGD(TAG, "[CACHE] Served %lu ms old value, refresh requested", (unsigned long)age_ms);
+    }
+}
+
+/* Look at incoming ZCL frames before the stack handles them: a Read
+ * Attributes of LocalTemperature or RunningMode on the thermostat cluster
+ * goes through the read cache. Always returns false so the stack still
+ * builds the response. */
+static bool zb_raw_command_handler(uint8_t bufid)
+{
+    zb_zcl_parsed_hdr_t *cmd_info = ZB_BUF_GET_PARAM(bufid, zb_zcl_parsed_hdr_t);
+    
+    if (!cmd_info->is_common_command || cmd_info->cmd_id != ZB_ZCL_CMD_READ_ATTRIB ||
+        cmd_info->cluster_id != ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT ||
+        ZB_ZCL_PARSED_HDR_SHORT_DATA(cmd_info).dst_endpoint != HA_ESP_HVAC_ENDPOINT) {
+        return false;
+    }
+    
+    /* Payload: list of little-endian attribute IDs */
+    const uint8_t *payload = (const uint8_t *)zb_buf_begin(bufid);
+    uint32_t len = zb_buf_len(bufid);
+    for (uint32_t i = 0; i + 1 < len; i += 2) {
+        uint16_t attr_id = payload[i] | (payload[i + 1] << 8);
+        if (attr_id == ESP_ZB_ZCL_ATTR_THERMOSTAT_LOCAL_TEMPERATURE_ID ||
+            attr_id == ESP_ZB_ZCL_ATTR_THERMOSTAT_RUNNING_MODE_ID) {
+            hvac_cache_on_read();
+            break;
+        }
+    }
+    return false;
+}
+
+/* Track the worst-case time spent in zb_attribute_handler on the Zigbee task */
+static void hvac_record_handler_time(uint32_t elapsed_us)
+{
+    static uint32_t handler_wcet_us = 0;
+    
+    if (elapsed_us <= handler_wcet_us) {
+        return;
+    }
+    handler_wcet_us = elapsed_us;
+    ESP_LOGI(TAG, "[DIAG] New attribute handler WCET: %lu us", (unsigned long)handler_wcet_us);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_DIAG_ATTR_HANDLER_WCET_ID,
+                                 &handler_wcet_us, false);
+}
+
 static esp_err_t zb_action_handler(esp_zb_core_action_callback_id_t callback_id, const void *message)
 {
     esp_err_t ret = ESP_OK;
     
     switch (callback_id) {
-    case ESP_ZB_CORE_SET_ATTR_VALUE_CB_ID:
+    case ESP_ZB_CORE_SET_ATTR_VALUE_CB_ID: {
+        int64_t start_us = esp_timer_get_time();
         ret = zb_attribute_handler((esp_zb_zcl_set_attr_value_message_t *)message);
+        hvac_record_handler_time((uint32_t)(esp_timer_get_time() - start_us));
         break;
+    }
         
     case ESP_ZB_CORE_REPORT_ATTR_CB_ID:
         ESP_LOGD(TAG, "Report attribute callback");
@@ -636,8 +965,244 @@ static esp_err_t zb_action_handler(esp_zb_core_action_callback_id_t callback_id,
     return ret;
 }
 
+/* Load the reporting and polling configuration from NVS (defaults if absent) */
+static void hvac_load_zb_settings(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open(ZB_NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        ESP_LOGI(TAG, "[REPORT] No saved reporting config, using defaults");
+        return;
+    }
+    
+    nvs_get_u16(nvs_handle, "lt_min", &temp_reporting.min_interval_s);
+    nvs_get_u16(nvs_handle, "lt_max", &temp_reporting.max_interval_s);
+    nvs_get_u16(nvs_handle, "lt_change", &temp_reporting.change_cd);
+    nvs_get_u16(nvs_handle, "poll_min", &poll_config.min_s);
+    nvs_get_u16(nvs_handle, "poll_max", &poll_config.max_s);
+    nvs_get_u16(nvs_handle, "rt_age", &cache_config.max_age_s);
+    nvs_get_u16(nvs_handle, "rt_wait", &cache_config.wait_ms);
+    nvs_close(nvs_handle);
+}
+
+/* Persist the reporting and polling configuration */
+static esp_err_t hvac_save_zb_settings(void)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err = nvs_open(ZB_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "[REPORT] Failed to open NVS: %s", esp_err_to_name(err));
+        return err;
+    }
+    
+    nvs_set_u16(nvs_handle, "lt_min", temp_reporting.min_interval_s);
+    nvs_set_u16(nvs_handle, "lt_max", temp_reporting.max_interval_s);
+    nvs_set_u16(nvs_handle, "lt_change", temp_reporting.change_cd);
+    nvs_set_u16(nvs_handle, "poll_min", poll_config.min_s);
+    nvs_set_u16(nvs_handle, "poll_max", poll_config.max_s);
+    nvs_set_u16(nvs_handle, "rt_age", cache_config.max_age_s);
+    nvs_set_u16(nvs_handle, "rt_wait", cache_config.wait_ms);
+    err = nvs_commit(nvs_handle);
+    nvs_close(nvs_handle);
+    return err;
+}
+
+/* Install temp_reporting as the LocalTemperature reporting configuration
+ * (a later Configure Reporting from the coordinator still takes precedence until reboot) */
+static void hvac_apply_temp_reporting(void)
+{
+    esp_zb_zcl_reporting_info_t reporting_info = {
+        .direction = ESP_ZB_ZCL_CMD_DIRECTION_TO_SRV,
+        .ep = HA_ESP_HVAC_ENDPOINT,
+        .cluster_id = ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
+        .cluster_role = ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+        .attr_id = ESP_ZB_ZCL_ATTR_THERMOSTAT_LOCAL_TEMPERATURE_ID,
+        .dst.profile_id = ESP_ZB_AF_HA_PROFILE_ID,
+        .manuf_code = ESP_ZB_ZCL_ATTR_NON_MANUFACTURER_SPECIFIC,
+    };
+    reporting_info.u.send_info.min_interval = temp_reporting.min_interval_s;
+    reporting_info.u.send_info.max_interval = temp_reporting.max_interval_s;
+    reporting_info.u.send_info.def_min_interval = temp_reporting.min_interval_s;
+    reporting_info.u.send_info.def_max_interval = temp_reporting.max_interval_s;
+    reporting_info.u.send_info.delta.u16 = temp_reporting.change_cd;
+    
+    esp_err_t err = esp_zb_zcl_update_reporting_info(&reporting_info);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "[REPORT] Failed to update LocalTemperature reporting: %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "[REPORT] LocalTemperature: min=%us max=%us change=%u cd",
+             temp_reporting.min_interval_s, temp_reporting.max_interval_s, temp_reporting.change_cd);
+}
+
+/* Mirror the ambient filter and reporting configuration into the config cluster */
+static void hvac_update_config_attributes(void)
+{
+    hvac_ambient_filter_t filter;
+    if (hvac_get_ambient_filter(&filter) == ESP_OK) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     HVAC_CONFIG_ATTR_AMBIENT_DEADBAND_ID,
+                                     &filter.deadband_cd, false);
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     HVAC_CONFIG_ATTR_AMBIENT_EMA_SHIFT_ID,
+                                     &filter.ema_shift, false);
+    }
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_CONFIG_ATTR_TEMP_REPORT_MIN_ID,
+                                 &temp_reporting.min_interval_s, false);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_CONFIG_ATTR_TEMP_REPORT_MAX_ID,
+                                 &temp_reporting.max_interval_s, false);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_CONFIG_ATTR_TEMP_REPORT_CHANGE_ID,
+                                 &temp_reporting.change_cd, false);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_CONFIG_ATTR_POLL_MIN_ID,
+                                 &poll_config.min_s, false);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_CONFIG_ATTR_POLL_MAX_ID,
+                                 &poll_config.max_s, false);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_CONFIG_ATTR_CACHE_MAX_AGE_ID,
+                                 &cache_config.max_age_s, false);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_CONFIG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_CONFIG_ATTR_CACHE_WAIT_ID,
+                                 &cache_config.wait_ms, false);
+}
+
+/* Handle writes to the configuration cluster */
+static esp_err_t hvac_config_attribute_handler(const esp_zb_zcl_set_attr_value_message_t *message)
+{
+    esp_err_t ret = ESP_OK;
+    hvac_ambient_filter_t filter;
+    hvac_temp_reporting_t reporting = temp_reporting;
+    
+    switch (message->attribute.id) {
+    case HVAC_CONFIG_ATTR_AMBIENT_DEADBAND_ID:
+    case HVAC_CONFIG_ATTR_AMBIENT_EMA_SHIFT_ID:
+        ret = hvac_get_ambient_filter(&filter);
+        if (ret != ESP_OK) {
+            break;
+        }
+        if (message->attribute.id == HVAC_CONFIG_ATTR_AMBIENT_DEADBAND_ID) {
+            filter.deadband_cd = *(uint16_t *)message->attribute.data.value;
+        } else {
+            filter.ema_shift = *(uint8_t *)message->attribute.data.value;
+        }
+        // A huge deadband would freeze LocalTemperature and survive reboots
+        if (filter.deadband_cd > HVAC_AMBIENT_DEADBAND_CD_MAX ||
+            filter.ema_shift > HVAC_AMBIENT_EMA_SHIFT_MAX) {
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        ret = hvac_set_ambient_filter(&filter);
+        break;
+        
+    case HVAC_CONFIG_ATTR_TEMP_REPORT_MIN_ID:
+    case HVAC_CONFIG_ATTR_TEMP_REPORT_MAX_ID:
+    case HVAC_CONFIG_ATTR_TEMP_REPORT_CHANGE_ID: {
+        uint16_t value = *(uint16_t *)message->attribute.data.value;
+        if (message->attribute.id == HVAC_CONFIG_ATTR_TEMP_REPORT_MIN_ID) {
+            reporting.min_interval_s = value;
+        } else if (message->attribute.id == HVAC_CONFIG_ATTR_TEMP_REPORT_MAX_ID) {
+            reporting.max_interval_s = value;
+        } else {
+            reporting.change_cd = value;
+        }
+        // max_interval 0 disables periodic reports; otherwise it must not undercut min_interval
+        if (reporting.max_interval_s != 0 && reporting.max_interval_s < reporting.min_interval_s) {
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        temp_reporting = reporting;
+        hvac_apply_temp_reporting();
+        ret = hvac_save_zb_settings();
+        break;
+    }
+    
+    case HVAC_CONFIG_ATTR_POLL_MIN_ID:
+    case HVAC_CONFIG_ATTR_POLL_MAX_ID: {
+        hvac_poll_config_t poll = poll_config;
+        uint16_t value = *(uint16_t *)message->attribute.data.value;
+        if (message->attribute.id == HVAC_CONFIG_ATTR_POLL_MIN_ID) {
+            poll.min_s = value;
+        } else {
+            poll.max_s = value;
+        }
+        if (poll.min_s == 0 || poll.max_s < poll.min_s) {
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        poll_config = poll;
+        ESP_LOGI(TAG, "[POLL] Status poll interval %u-%us", poll.min_s, poll.max_s);
+        hvac_poll_kick();
+        ret = hvac_save_zb_settings();
+        break;
+    }
+    
+    case HVAC_CONFIG_ATTR_CACHE_MAX_AGE_ID:
+        cache_config.max_age_s = *(uint16_t *)message->attribute.data.value;
+        ret = hvac_save_zb_settings();
+        break;
+        
+    case HVAC_CONFIG_ATTR_CACHE_WAIT_ID:
+        cache_config.wait_ms = *(uint16_t *)message->attribute.data.value;
+        ret = hvac_save_zb_settings();
+        break;
+        
+    default:
+        ESP_LOGD(TAG, "Unhandled config attribute: 0x%x", message->attribute.id);
+        return ESP_OK;
+    }
+    
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "[CONFIG] Write to 0x%04x rejected: %s", message->attribute.id, esp_err_to_name(ret));
+    }
+    // Re-sync the stored attribute values with what actually took effect
+    hvac_update_config_attributes();
+    return ret;
+}
+
+/* Publish the boot phase timestamps through the diagnostics cluster */
+static void hvac_update_boot_profile_attribute(void)
+{
+    static uint8_t boot_profile_zigbee[1 + HVAC_BOOT_SERIALIZED_LEN];
+    boot_profile_zigbee[0] = hvac_boot_profile_serialize(&boot_profile_zigbee[1], HVAC_BOOT_SERIALIZED_LEN);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_DIAG_ATTR_BOOT_PROFILE_ID,
+                                 boot_profile_zigbee, false);
+}
+
+/* Publish the latency histograms through the diagnostics cluster */
+static void hvac_update_latency_attribute(void)
+{
+    // Octet string format: first byte is length, followed by data
+    static uint8_t latency_hist_zigbee[1 + HVAC_LAT_SERIALIZED_LEN];
+    
+    latency_hist_zigbee[0] = hvac_latency_serialize(&latency_hist_zigbee[1], HVAC_LAT_SERIALIZED_LEN);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 HVAC_DIAG_ATTR_LATENCY_HIST_ID,
+                                 latency_hist_zigbee, false);
+}
+
+/* Update the Zigbee attributes whose HVAC_DIRTY_* bits are pending
+ * param: HVAC_ZB_UPDATE_ALL to rewrite every attribute regardless of the mask */
 static void hvac_update_zigbee_attributes(uint8_t param)
 {
+    /* Clear the in-flight flag before reading the state, so a change decoded
+     * from here on requests a fresh pass instead of being dropped */
+    atomic_store(&zb_refresh_pending, false);
+    
     hvac_state_t state;
     esp_err_t ret = hvac_get_state(&state);
     
@@ -646,191 +1211,298 @@ static void hvac_update_zigbee_attributes(uint8_t param)
         return;
     }
     
-    uint8_t running_mode = 0x00;  // Declare at function scope for final log
+    uint32_t dirty = atomic_exchange(&zb_pending_dirty, 0);
+    if (param == HVAC_ZB_UPDATE_ALL) {
+        dirty = HVAC_DIRTY_ALL;
+    }
+    if (dirty == 0) {
+        return;
+    }
     
-    /* Update system mode */
+    uint8_t running_mode = 0x00;  // Declare at function scope for final log
     uint8_t system_mode = 0x00;  // Off
-    if (state.power_on) {
-        switch (state.mode) {
-            case HVAC_MODE_AUTO: system_mode = 0x01; break;
-            case HVAC_MODE_COOL: system_mode = 0x03; break;
-            case HVAC_MODE_HEAT: system_mode = 0x04; break;
-            case HVAC_MODE_FAN:  system_mode = 0x07; break;
-            case HVAC_MODE_DRY:  system_mode = 0x08; break;
-            default: system_mode = 0x00; break;
+    bool power_on = hvac_state_has(&state, HVAC_STATE_POWER);
+    uint32_t attr_writes = 0;
+    
+    if (dirty & (HVAC_STATE_POWER | HVAC_DIRTY_MODE)) {
+        /* Update system mode */
+        if (power_on) {
+            switch (state.mode) {
+                case HVAC_MODE_AUTO: system_mode = 0x01; break;
+                case HVAC_MODE_COOL: system_mode = 0x03; break;
+                case HVAC_MODE_HEAT: system_mode = 0x04; break;
+                case HVAC_MODE_FAN:  system_mode = 0x07; break;
+                case HVAC_MODE_DRY:  system_mode = 0x08; break;
+                default: system_mode = 0x00; break;
+            }
         }
+        
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, 
+                                     ESP_ZB_ZCL_ATTR_THERMOSTAT_SYSTEM_MODE_ID,
+                                     &system_mode, false);
+        
+        /* Update running mode based on power and mode */
+        /* Note: Running mode shows what the AC is CURRENTLY doing (idle/heat/cool/fan)
+         * This is different from system mode which is what it's SET to (off/auto/cool/heat/dry/fan)
+         * For AUTO/DRY modes, we report 'idle' as running mode since we don't know what it's actually doing */
+        if (power_on) {
+            switch (state.mode) {
+                case HVAC_MODE_HEAT: running_mode = 0x04; break;  // Heat mode
+                case HVAC_MODE_COOL: running_mode = 0x03; break;  // Cool mode
+                case HVAC_MODE_FAN:  running_mode = 0x07; break;  // Fan only mode
+                default:             running_mode = 0x00; break;  // Idle for auto/dry/unknown modes
+            }
+        }
+        
+        ESP_LOGI(TAG, "[RUNNING_MODE] Final: running_mode=0x%02X (Power=%d, HVAC Mode=0x%02X)", 
+                 running_mode, power_on, state.mode);
+        
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_THERMOSTAT_RUNNING_MODE_ID,
+                                     &running_mode, false);
+        attr_writes += 2;
+        
+        /* Note: running_mode is not auto-reportable in ESP-Zigbee stack.
+         * Z2M will read this attribute when needed (e.g., on state refresh or periodic polling). */
     }
     
-    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, 
-                                 ESP_ZB_ZCL_ATTR_THERMOSTAT_SYSTEM_MODE_ID,
-                                 &system_mode, false);
-    
-    /* Update temperature setpoint (in centidegrees)
-     * ACW02 uses single setpoint - only update occupied_heating_setpoint.
-     * Leave cooling_setpoint at max (31°C) to avoid deadband validation conflicts.
-     * Home Assistant and Z2M use heating setpoint for thermostat control. */
-    int16_t temp_setpoint = state.target_temp_c * 100;
-    ESP_LOGI(TAG, "[TEMP] AC target: %d°C → Zigbee heating_setpoint: %d centidegrees", 
-             state.target_temp_c, temp_setpoint);
+    if (dirty & HVAC_DIRTY_TARGET) {
+        /* Update temperature setpoint (in centidegrees)
+         * ACW02 uses single setpoint - only update occupied_heating_setpoint.
+         * Leave cooling_setpoint at max (31°C) to avoid deadband validation conflicts.
+         * Home Assistant and Z2M use heating setpoint for thermostat control. */
+        int16_t temp_setpoint = state.target_temp_cd;
+        ESP_LOGI(TAG, "[TEMP] AC target: %d°C → Zigbee heating_setpoint: %d centidegrees", 
+                 temp_setpoint / 100, temp_setpoint);
+        
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_THERMOSTAT_OCCUPIED_HEATING_SETPOINT_ID,
+                                     &temp_setpoint, false);
+        attr_writes++;
+    }
     
-    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_THERMOSTAT_OCCUPIED_HEATING_SETPOINT_ID,
-                                 &temp_setpoint, false);
-    ESP_LOGD(TAG, "[TEMP] Updated heating_setpoint to %d", temp_setpoint);
+    if (dirty & HVAC_DIRTY_AMBIENT) {
+        /* Update local temperature (ambient) */
+        int16_t local_temp = state.ambient_temp_cd;
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_THERMOSTAT_LOCAL_TEMPERATURE_ID,
+                                     &local_temp, false);
+        attr_writes++;
+    }
     
-    /* Update local temperature (ambient) */
-    int16_t local_temp = state.ambient_temp_c * 100;
-    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_THERMOSTAT_LOCAL_TEMPERATURE_ID,
-                                 &local_temp, false);
-    
-    /* Update running mode based on power and mode */
-    /* Note: Running mode shows what the AC is CURRENTLY doing (idle/heat/cool/fan)
-     * This is different from system mode which is what it's SET to (off/auto/cool/heat/dry/fan)
-     * For AUTO/DRY modes, we report 'idle' as running mode since we don't know what it's actually doing */
-    running_mode = 0x00;  // Off/Idle (already declared at function scope)
-    
-    ESP_LOGI(TAG, "[DEBUG] Running mode calculation: power_on=%d, mode=0x%02X (HEAT=0x04, COOL=0x01, FAN=0x03, AUTO=0x00, DRY=0x02)", 
-             state.power_on, state.mode);
-    
-    if (state.power_on) {
-        switch (state.mode) {
-            case HVAC_MODE_HEAT:
-                running_mode = 0x04;  // Heat mode
-                ESP_LOGI(TAG, "[DEBUG] Matched HVAC_MODE_HEAT, setting running_mode=0x04");
-                break;
-            case HVAC_MODE_COOL:
-                running_mode = 0x03;  // Cool mode
-                ESP_LOGI(TAG, "[DEBUG] Matched HVAC_MODE_COOL, setting running_mode=0x03");
-                break;
-            case HVAC_MODE_FAN:
-                running_mode = 0x07;  // Fan only mode
-                ESP_LOGI(TAG, "[DEBUG] Matched HVAC_MODE_FAN, setting running_mode=0x07");
-                break;
-            case HVAC_MODE_AUTO:
-            case HVAC_MODE_DRY:
-            default:
-                running_mode = 0x00;  // Idle for auto/dry/unknown modes
-                ESP_LOGI(TAG, "[DEBUG] Matched AUTO/DRY/default, setting running_mode=0x00, state.mode=%d", state.mode);
-                break;
+    /* Update On/Off switch endpoints (Eco=2, Swing=3, Display=4, Night=5, Purifier=6, Clean=7 read-only, Mute=8) */
+    static const struct {
+        uint8_t endpoint;
+        uint32_t flag;
+    } switch_endpoints[] = {
+        { HA_ESP_ECO_ENDPOINT,      HVAC_STATE_ECO },
+        { HA_ESP_SWING_ENDPOINT,    HVAC_STATE_SWING },
+        { HA_ESP_DISPLAY_ENDPOINT,  HVAC_STATE_DISPLAY },
+        { HA_ESP_NIGHT_ENDPOINT,    HVAC_STATE_NIGHT },
+        { HA_ESP_PURIFIER_ENDPOINT, HVAC_STATE_PURIFIER },
+        { HA_ESP_CLEAN_ENDPOINT,    HVAC_STATE_CLEAN },
+        { HA_ESP_MUTE_ENDPOINT,     HVAC_STATE_MUTE },
+    };
+    for (size_t i = 0; i < sizeof(switch_endpoints) / sizeof(switch_endpoints[0]); i++) {
+        if (!(dirty & switch_endpoints[i].flag)) {
+            continue;
         }
-    } else {
-        ESP_LOGI(TAG, "[DEBUG] Power OFF, setting running_mode=0x00");
+        bool on = hvac_state_has(&state, switch_endpoints[i].flag);
+        esp_zb_zcl_set_attribute_val(switch_endpoints[i].endpoint, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
+                                     &on, false);
+        attr_writes++;
     }
     
-    ESP_LOGI(TAG, "[RUNNING_MODE] Final: running_mode=0x%02X (Power=%d, HVAC Mode=0x%02X)", 
-             running_mode, state.power_on, state.mode);
-    
-    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_THERMOSTAT,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_THERMOSTAT_RUNNING_MODE_ID,
-                                 &running_mode, false);
-    
-    /* Note: running_mode is not auto-reportable in ESP-Zigbee stack.
-     * Z2M will read this attribute when needed (e.g., on state refresh or periodic polling). */
-    
-    /* Update Eco Mode switch state - Endpoint 2 */
-    esp_zb_zcl_set_attribute_val(HA_ESP_ECO_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
-                                 &state.eco_mode, false);
-    
-    /* Update Swing switch state - Endpoint 3 */
-    esp_zb_zcl_set_attribute_val(HA_ESP_SWING_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
-                                 &state.swing_on, false);
+    if (dirty & (HVAC_DIRTY_ERROR_CODE | HVAC_STATE_ERROR)) {
+        /* Update error text in Basic cluster locationDescription attribute - Endpoint 1 */
+        // Zigbee string format: first byte is length, followed by chars
+        static char error_text_zigbee[65];  // Static to prevent stack corruption
+        memset(error_text_zigbee, 0, sizeof(error_text_zigbee));  // Clear buffer
+        
+        // Resolved from the raw warn/fault codes, text is not kept in the state
+        size_t text_len = hvac_format_error_text(&state, &error_text_zigbee[1], sizeof(error_text_zigbee) - 1);
+        error_text_zigbee[0] = text_len;  // Length byte
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_BASIC,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_BASIC_LOCATION_DESCRIPTION_ID,
+                                     error_text_zigbee, false);
+        
+        /* Update Error Status binary sensor - Endpoint 9 */
+        // Error status is ON when there's an error (non-empty error text)
+        bool error_status_on = (text_len > 0);
+        esp_zb_zcl_set_attribute_val(HA_ESP_ERROR_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
+                                     &error_status_on, false);
+        attr_writes += 2;
+        
+        /* Log error text when error/warning is active */
+        if (error_status_on) {
+            ESP_LOGW(TAG, "Error/Warning active: %s", &error_text_zigbee[1]);
+        }
+    }
     
-    /* Update Display switch state - Endpoint 4 */
-    esp_zb_zcl_set_attribute_val(HA_ESP_DISPLAY_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
-                                 &state.display_on, false);
+    if (dirty & HVAC_DIRTY_FAN) {
+        /* Update Fan Mode - Endpoint 1 */
+        // Report ACW02 protocol values directly to Zigbee
+        // Z2M converter will translate to custom names (quiet/low/low-med/etc)
+        uint8_t zigbee_fan_mode = state.fan_speed;  // Pass through ACW02 value
+        if (state.fan_speed == HVAC_FAN_TURBO) {
+            zigbee_fan_mode = HVAC_FAN_SILENT;  // Map TURBO to SILENT for now
+        }
+        
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     ESP_ZB_ZCL_ATTR_FAN_CONTROL_FAN_MODE_ID,
+                                     &zigbee_fan_mode, false);
+        attr_writes++;
+    }
     
-    /* Update Night Mode switch state - Endpoint 5 */
-    esp_zb_zcl_set_attribute_val(HA_ESP_NIGHT_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
-                                 &state.night_mode, false);
+    if (dirty & HVAC_STATE_PENDING) {
+        bool pending = hvac_state_has(&state, HVAC_STATE_PENDING);
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     HVAC_DIAG_ATTR_PENDING_ID,
+                                     &pending, false);
+        attr_writes++;
+    }
     
-    /* Update Purifier switch state - Endpoint 6 */
-    esp_zb_zcl_set_attribute_val(HA_ESP_PURIFIER_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
-                                 &state.purifier_on, false);
+    /* Close the latency measurement of the command that led to this update */
+    if (hvac_latency_mark(HVAC_LAT_ATTRIBUTES)) {
+        hvac_update_latency_attribute();
+    }
     
-    /* Update Clean status binary sensor - Endpoint 7 (Read-Only) */
-    esp_zb_zcl_set_attribute_val(HA_ESP_CLEAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
+    /* Requested vs executed shows how many refreshes were coalesced */
+    uint32_t refresh_requested = atomic_load_explicit(&zb_refresh_requested, memory_order_relaxed);
+    uint32_t refresh_executed = atomic_fetch_add_explicit(&zb_refresh_executed, 1, memory_order_relaxed) + 1;
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
-                                 &state.clean_status, false);
-    
-    /* Update Mute switch state - Endpoint 8 */
-    esp_zb_zcl_set_attribute_val(HA_ESP_MUTE_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
+                                 HVAC_DIAG_ATTR_REFRESH_REQ_ID,
+                                 &refresh_requested, false);
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
-                                 &state.mute_on, false);
+                                 HVAC_DIAG_ATTR_REFRESH_RUN_ID,
+                                 &refresh_executed, false);
+    
+    /* First push of real AC state to a live network closes the boot profile */
+    if (zb_network_up && hvac_get_status_age_ms() != UINT32_MAX) {
+        hvac_boot_profile_t boot;
+        hvac_boot_profile_get(&boot, NULL);
+        if (boot.phase_ms[HVAC_BOOT_FIRST_REPORT] == 0) {
+            hvac_boot_mark(HVAC_BOOT_FIRST_REPORT);
+            hvac_update_boot_profile_attribute();
+        }
+    }
     
-    /* Update error text in Basic cluster locationDescription attribute - Endpoint 1 */
-    // Zigbee string format: first byte is length, followed by chars
-    static char error_text_zigbee[65];  // Static to prevent stack corruption
-    memset(error_text_zigbee, 0, sizeof(error_text_zigbee));  // Clear buffer
+    ESP_LOGI(TAG, "Updated %lu Zigbee attributes (dirty=0x%06lX): Power=%d, Mode=%d, LocalTemp=%d.%d°C, TargetTemp=%d°C, Fan=%d", 
+             (unsigned long)attr_writes, (unsigned long)dirty, power_on, state.mode,
+             state.ambient_temp_cd / 100, (state.ambient_temp_cd % 100) / 10, state.target_temp_cd / 100, state.fan_speed);
+    ESP_LOGD(TAG, "  Flags=0x%03lX, Warn=0x%02X, Fault=0x%02X", 
+             (unsigned long)state.flags, state.warn_code, state.fault_code);
+}
+
+/* Restart the poll burst: next status request at the minimum interval (any task, no lock) */
+static void hvac_poll_kick(void)
+{
+    if (poll_task_handle) {
+        xTaskNotifyGive(poll_task_handle);
+    }
+}
+
+/* Request status on a schedule: burst interval after a kick, doubling up to
+ * the ceiling when idle */
+static void hvac_poll_task(void *arg)
+{
+    uint32_t interval_ms = 0;
+    uint8_t burst_left = 0;
+    TickType_t wait = portMAX_DELAY;
     
-    size_t text_len = strlen(state.error_text);
-    if (text_len > 64) text_len = 64;
-    error_text_zigbee[0] = text_len;  // Length byte
-    if (text_len > 0) {
-        memcpy(&error_text_zigbee[1], state.error_text, text_len);
+    for (;;) {
+        if (ulTaskNotifyTake(pdTRUE, wait) > 0) {
+            burst_left = HVAC_POLL_BURST_COUNT;
+            interval_ms = poll_config.min_s * 1000;
+            wait = pdMS_TO_TICKS(interval_ms);
+            continue;
+        }
+        
+        hvac_request_status();
+        
+        if (burst_left > 0) {
+            burst_left--;
+        } else {
+            uint32_t ceiling_ms = poll_config.max_s * 1000;
+            hvac_state_t state;
+            if (hvac_get_state(&state) == ESP_OK && hvac_state_has(&state, HVAC_STATE_POWER) &&
+                ceiling_ms > HVAC_POLL_ACTIVE_MAX_S * 1000) {
+                ceiling_ms = HVAC_POLL_ACTIVE_MAX_S * 1000;
+            }
+            interval_ms *= 2;
+            if (interval_ms > ceiling_ms) {
+                interval_ms = ceiling_ms;
+            }
+        }
+        
+        ESP_LOGD(TAG, "[POLL] Next status request in %lu ms", (unsigned long)interval_ms);
+        wait = pdMS_TO_TICKS(interval_ms);
+    }
+}
+
+static void hvac_keepalive_task(uint8_t param)
+{
+    /* Send keepalive to HVAC (required to maintain UART connection).
+     * Skipped when a status poll answered within the interval: that
+     * exchange already kept the link alive */
+    static uint32_t keepalives_sent = 0;
+    static uint32_t keepalives_skipped = 0;
+    if (hvac_get_status_age_ms() < HVAC_KEEPALIVE_INTERVAL_MS) {
+        keepalives_skipped++;
+    } else {
+        hvac_send_keepalive();
+        keepalives_sent++;
     }
-    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_BASIC,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_BASIC_LOCATION_DESCRIPTION_ID,
-                                 error_text_zigbee, false);
     
-    /* Update Error Status binary sensor - Endpoint 9 */
-    // Error status is ON when there's an error (non-empty error text)
-    bool error_status_on = (text_len > 0);
-    esp_zb_zcl_set_attribute_val(HA_ESP_ERROR_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF,
-                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID,
-                                 &error_status_on, false);
+    /* Count a background read refresh the AC never answered */
+    hvac_cache_refresh_check();
     
-    /* Log error text when error/warning is active */
-    bool error_active = state.error || state.clean_status;
-    if (error_active) {
-        ESP_LOGW(TAG, "Error/Warning active: %s", state.error_text);
+    /* Flush changes left over from a refresh that could not get the stack lock */
+    if (atomic_load(&zb_pending_dirty) != 0 && !atomic_exchange(&zb_refresh_pending, true)) {
+        hvac_update_zigbee_attributes(0);
     }
     
-    /* Update Fan Mode - Endpoint 1 */
-    // Report ACW02 protocol values directly to Zigbee
-    // Z2M converter will translate to custom names (quiet/low/low-med/etc)
-    uint8_t zigbee_fan_mode = state.fan_speed;  // Pass through ACW02 value
-    if (state.fan_speed == HVAC_FAN_TURBO) {
-        zigbee_fan_mode = HVAC_FAN_SILENT;  // Map TURBO to SILENT for now
+    /* Flash wear counters (change at most once per NVS save) */
+    hvac_nvs_stats_t nvs_stats;
+    if (hvac_get_nvs_stats(&nvs_stats) == ESP_OK) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     HVAC_DIAG_ATTR_NVS_COMMITS_ID,
+                                     &nvs_stats.commits, false);
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     HVAC_DIAG_ATTR_NVS_SKIPPED_ID,
+                                     &nvs_stats.skipped, false);
+        esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
+                                     ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                     HVAC_DIAG_ATTR_NVS_ERASES_ID,
+                                     &nvs_stats.page_erases, false);
     }
     
-    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL,
+    uint32_t boot_sync_ms = hvac_get_boot_sync_ms();
+    esp_zb_zcl_set_attribute_val(HA_ESP_HVAC_ENDPOINT, HVAC_DIAG_CLUSTER_ID,
                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
-                                 ESP_ZB_ZCL_ATTR_FAN_CONTROL_FAN_MODE_ID,
-                                 &zigbee_fan_mode, false);
-    
-    ESP_LOGI(TAG, "Updated Zigbee attributes: Mode=%d, LocalTemp=%.1f°C, TargetTemp=%d°C, Fan=%d, RunningMode=0x%02X", 
-             system_mode, state.ambient_temp_c, state.target_temp_c, zigbee_fan_mode, running_mode);
-    ESP_LOGI(TAG, "  Switches: Eco=%d, Night=%d, Display=%d, Purifier=%d, Clean=%d, Swing=%d, Mute=%d", 
-             state.eco_mode, state.night_mode, state.display_on, state.purifier_on, 
-             state.clean_status, state.swing_on, state.mute_on);
-}
-
-static void hvac_keepalive_task(uint8_t param)
-{
-    /* Send keepalive to HVAC (required to maintain UART connection) */
-    hvac_send_keepalive();
+                                 HVAC_DIAG_ATTR_BOOT_SYNC_ID,
+                                 &boot_sync_ms, false);
     
-    /* Also request status to ensure UART stays synchronized */
-    hvac_request_status();
+    /* AC silent at boot (e.g. powered up later): validate once it answers */
+    if (!hvac_link_validated && hvac_get_status_age_ms() != UINT32_MAX) {
+        hvac_link_validated = true;
+        ota_validation_hw_init_ok();
+    }
     
     /* Log Zigbee TX power every hour for monitoring */
     static uint8_t log_counter = 0;
@@ -838,6 +1510,10 @@ static void hvac_keepalive_task(uint8_t param)
         int8_t tx_power = 0;
         esp_zb_get_tx_power(&tx_power);
         ESP_LOGI(TAG, "[RF] Zigbee TX power: %d dBm", tx_power);
+        ESP_LOGI(TAG, "[ZB] Attribute refreshes: %u requested, %u executed",
+                 atomic_load(&zb_refresh_requested), atomic_load(&zb_refresh_executed));
+        ESP_LOGI(TAG, "[UART] Keepalives: %lu sent, %lu skipped after a recent status poll",
+                 (unsigned long)keepalives_sent, (unsigned long)keepalives_skipped);
         log_counter = 0;
     }
     
@@ -886,6 +1562,13 @@ static void esp_zb_task(void *pvParameters)
 
     esp_zb_init(&zb_nwk_cfg);
     ESP_LOGI(TAG, "[OK] Zigbee stack initialized");
+    hvac_boot_mark(HVAC_BOOT_ZB_INIT);
+    
+    /* Bring up the HVAC driver while clusters are created and the stack starts */
+    if (xTaskCreate(hvac_driver_init_task, "hvac_init", 4096, NULL, 5, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "[ERROR] Failed to create HVAC init task");
+        hvac_driver_state = HVAC_DRIVER_FAILED;
+    }
 
     /* Log current Zigbee TX power and optionally apply a default from sdkconfig */
     {
@@ -1052,6 +1735,117 @@ static void esp_zb_task(void *pvParameters)
                                                              ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
     ESP_LOGI(TAG, "  [OK] Identify cluster added");
     
+    /* Add manufacturer-specific diagnostics cluster */
+    ESP_LOGI(TAG, "  [+] Adding diagnostics cluster (0x%04X)...", HVAC_DIAG_CLUSTER_ID);
+    static uint8_t latency_hist_init[1 + HVAC_LAT_SERIALIZED_LEN];
+    latency_hist_init[0] = hvac_latency_serialize(&latency_hist_init[1], HVAC_LAT_SERIALIZED_LEN);
+    esp_zb_attribute_list_t *esp_zb_diag_cluster = esp_zb_zcl_attr_list_create(HVAC_DIAG_CLUSTER_ID);
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_LATENCY_HIST_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          latency_hist_init));
+    static uint8_t boot_profile_init[1 + HVAC_BOOT_SERIALIZED_LEN];
+    boot_profile_init[0] = hvac_boot_profile_serialize(&boot_profile_init[1], HVAC_BOOT_SERIALIZED_LEN);
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_BOOT_PROFILE_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          boot_profile_init));
+    uint32_t refresh_count_init = 0;
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_REFRESH_REQ_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_REFRESH_RUN_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_HANDLER_WCET_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_CACHE_HITS_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_CACHE_MISSES_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_CACHE_STALE_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_BOOT_SYNC_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_NVS_COMMITS_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_NVS_SKIPPED_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_NVS_ERASES_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY,
+                                                          &refresh_count_init));
+    bool pending_init = false;
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_diag_cluster, HVAC_DIAG_ATTR_PENDING_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_BOOL,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING,
+                                                          &pending_init));
+    ESP_ERROR_CHECK(esp_zb_cluster_list_add_custom_cluster(esp_zb_hvac_clusters, esp_zb_diag_cluster,
+                                                           ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+    ESP_LOGI(TAG, "  [OK] Diagnostics cluster added");
+    
+    /* Add manufacturer-specific configuration cluster (driver is not up yet: start from defaults) */
+    ESP_LOGI(TAG, "  [+] Adding configuration cluster (0x%04X)...", HVAC_CONFIG_CLUSTER_ID);
+    hvac_load_zb_settings();
+    uint16_t ambient_deadband = HVAC_AMBIENT_DEADBAND_CD_DEFAULT;
+    uint8_t ambient_ema_shift = HVAC_AMBIENT_EMA_SHIFT_DEFAULT;
+    esp_zb_attribute_list_t *esp_zb_config_cluster = esp_zb_zcl_attr_list_create(HVAC_CONFIG_CLUSTER_ID);
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_AMBIENT_DEADBAND_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &ambient_deadband));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_AMBIENT_EMA_SHIFT_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U8,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &ambient_ema_shift));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_TEMP_REPORT_MIN_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &temp_reporting.min_interval_s));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_TEMP_REPORT_MAX_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &temp_reporting.max_interval_s));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_TEMP_REPORT_CHANGE_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &temp_reporting.change_cd));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_POLL_MIN_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &poll_config.min_s));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_POLL_MAX_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &poll_config.max_s));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_CACHE_MAX_AGE_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &cache_config.max_age_s));
+    ESP_ERROR_CHECK(esp_zb_custom_cluster_add_custom_attr(esp_zb_config_cluster, HVAC_CONFIG_ATTR_CACHE_WAIT_ID,
+                                                          ESP_ZB_ZCL_ATTR_TYPE_U16,
+                                                          ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE,
+                                                          &cache_config.wait_ms));
+    ESP_ERROR_CHECK(esp_zb_cluster_list_add_custom_cluster(esp_zb_hvac_clusters, esp_zb_config_cluster,
+                                                           ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
+    ESP_LOGI(TAG, "  [OK] Configuration cluster added");
+    
     /* Add OTA cluster for firmware updates */
     ESP_LOGI(TAG, "  [+] Adding OTA cluster (0x0019)...");
     esp_zb_ota_cluster_cfg_t ota_cluster_cfg = {
@@ -1368,6 +2162,9 @@ static void esp_zb_task(void *pvParameters)
     esp_zb_device_register(esp_zb_ep_list);
     ESP_LOGI(TAG, "[OK] Device registered");
     
+    /* Default LocalTemperature reporting, so jitter does not flood the mesh before the coordinator configures it */
+    hvac_apply_temp_reporting();
+    
     /* Debug: Verify REPORTING flag is set on thermostat attributes */
     ESP_LOGI(TAG, "🔍 Verifying REPORTING flag on thermostat attributes...");
     esp_zb_zcl_attr_t *attr;
@@ -1461,6 +2258,7 @@ static void esp_zb_task(void *pvParameters)
     
     ESP_LOGI(TAG, "[REG] Registering action handler...");
     esp_zb_core_action_handler_register(zb_action_handler);
+    esp_zb_raw_command_handler_register(zb_raw_command_handler);
     ESP_LOGI(TAG, "[OK] Action handler registered");
     
     /* Initialize and register OTA */
@@ -1483,6 +2281,7 @@ static void esp_zb_task(void *pvParameters)
     ESP_LOGI(TAG, "[START] Starting Zigbee stack...");
     ESP_ERROR_CHECK(esp_zb_start(false));
     ESP_LOGI(TAG, "[OK] Zigbee stack started successfully");
+    hvac_boot_mark(HVAC_BOOT_ZB_STARTED);
     
     /* Start main Zigbee stack loop */
     esp_zb_stack_main_loop();
@@ -1632,6 +2431,7 @@ void ota_validation_mark_invalid(void)
 }
 void app_main(void)
 {
+    hvac_boot_profile_start();
     ESP_LOGI(OTA_VALIDATION_TAG, "=== Application Starting ===");
     esp_app_desc_t app_desc;
     const esp_partition_t *running = esp_ota_get_running_partition();
@@ -1648,16 +2448,7 @@ void app_main(void)
     ESP_ERROR_CHECK(nvs_flash_init());
     ESP_ERROR_CHECK(esp_zb_platform_config(&config));
 
-    // Hardware init
-    ESP_LOGI(OTA_VALIDATION_TAG, "Initializing hardware...");
-    bool hw_ok = true; // Replace with actual check
-    if (hw_ok) {
-        ota_validation_hw_init_ok();
-    } else {
-        ESP_LOGE(OTA_VALIDATION_TAG, "Hardware initialization failed!");
-        ota_validation_mark_invalid();
-        return;
-    }
+    // Hardware is validated in hvac_attach_driver() once the AC answers a status request
 
     // Zigbee stack init
     ESP_LOGI(OTA_VALIDATION_TAG, "Initializing Zigbee stack...");
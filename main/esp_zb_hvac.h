@@ -28,6 +28,52 @@
 #define HA_ESP_ERROR_ENDPOINT           9                                    /* Error/diagnostics binary sensor endpoint */
 #define ESP_ZB_PRIMARY_CHANNEL_MASK     ESP_ZB_TRANSCEIVER_ALL_CHANNELS_MASK /* Zigbee primary channel mask use in the example */
 
+/* Manufacturer-specific diagnostics cluster on the HVAC endpoint */
+#define HVAC_DIAG_CLUSTER_ID            0xFC01                               /* ACW02 diagnostics */
+#define HVAC_DIAG_ATTR_LATENCY_HIST_ID  0x0000                               /* Octet string: command latency histograms */
+#define HVAC_DIAG_ATTR_REFRESH_REQ_ID   0x0001                               /* U32: attribute refreshes requested by the driver */
+#define HVAC_DIAG_ATTR_REFRESH_RUN_ID   0x0002                               /* U32: attribute refreshes actually executed */
+#define HVAC_DIAG_ATTR_HANDLER_WCET_ID  0x0003                               /* U32: worst attribute handler time (us) */
+#define HVAC_DIAG_ATTR_PENDING_ID       0x0004                               /* Bool: a request is not confirmed by the AC yet */
+#define HVAC_DIAG_ATTR_CACHE_HITS_ID    0x0005                               /* U32: LocalTemperature/RunningMode reads served with a fresh value */
+#define HVAC_DIAG_ATTR_CACHE_MISSES_ID  0x0006                               /* U32: LocalTemperature/RunningMode reads served with an old value (refresh queued) */
+#define HVAC_DIAG_ATTR_CACHE_STALE_ID   0x0007                               /* U32: background refreshes the AC did not answer in time */
+#define HVAC_DIAG_ATTR_NVS_COMMITS_ID   0x0008                               /* U32: settings commits to flash (NVS: lifetime, journal: since boot) */
+#define HVAC_DIAG_ATTR_NVS_SKIPPED_ID   0x0009                               /* U32: saves skipped, flash already up to date */
+#define HVAC_DIAG_ATTR_NVS_ERASES_ID    0x000A                               /* U32: NVS page erases (estimated, lifetime) or journal sector erases (since boot) */
+#define HVAC_DIAG_ATTR_BOOT_SYNC_ID     0x000B                               /* U32: ms from reset until the AC matched the settings (0 = not yet) */
+#define HVAC_DIAG_ATTR_BOOT_PROFILE_ID  0x000C                               /* Octet string: boot phase timestamps, this and previous boot */
+
+/* Manufacturer-specific configuration cluster on the HVAC endpoint */
+#define HVAC_CONFIG_CLUSTER_ID                  0xFC02                       /* ACW02 tunables (persisted in NVS) */
+#define HVAC_CONFIG_ATTR_AMBIENT_DEADBAND_ID    0x0000                       /* U16: ambient deadband in 0.01°C, max 200 */
+#define HVAC_CONFIG_ATTR_AMBIENT_EMA_SHIFT_ID   0x0001                       /* U8: ambient EMA weight 1/2^n, n max 6 */
+#define HVAC_CONFIG_ATTR_TEMP_REPORT_MIN_ID     0x0010                       /* U16: LocalTemperature min report interval (s) */
+#define HVAC_CONFIG_ATTR_TEMP_REPORT_MAX_ID     0x0011                       /* U16: LocalTemperature max report interval (s) */
+#define HVAC_CONFIG_ATTR_TEMP_REPORT_CHANGE_ID  0x0012                       /* U16: LocalTemperature reportable change (0.01°C) */
+#define HVAC_CONFIG_ATTR_POLL_MIN_ID            0x0020                       /* U16: status poll interval after a change (s) */
+#define HVAC_CONFIG_ATTR_POLL_MAX_ID            0x0021                       /* U16: status poll back-off ceiling (s) */
+#define HVAC_CONFIG_ATTR_CACHE_MAX_AGE_ID       0x0030                       /* U16: read cache staleness bound (s), 0 = off */
+#define HVAC_CONFIG_ATTR_CACHE_WAIT_ID          0x0031                       /* U16: deadline for a background refresh (ms) */
+
+/* LocalTemperature reporting defaults */
+#define HVAC_TEMP_REPORT_MIN_S_DEFAULT          30
+#define HVAC_TEMP_REPORT_MAX_S_DEFAULT          600
+#define HVAC_TEMP_REPORT_CHANGE_CD_DEFAULT      50                           /* 0.5°C */
+
+/* Adaptive status polling defaults */
+#define HVAC_POLL_MIN_S_DEFAULT                 1                            /* Burst interval after a change */
+#define HVAC_POLL_MAX_S_DEFAULT                 300                          /* Idle ceiling while the unit is off */
+
+/* Thermostat read cache defaults. The cache is refresh-ahead, not
+ * read-through: a read never waits for the AC (a blocking wait would hold
+ * the Zigbee task). A read that finds the last status older than
+ * MAX_AGE is answered with that value and counted as a miss, and a status
+ * request is queued so the next read and the attribute reports see fresh
+ * data. WAIT is the deadline for that request, not a wait in the read. */
+#define HVAC_CACHE_MAX_AGE_S_DEFAULT            10
+#define HVAC_CACHE_WAIT_MS_DEFAULT              1000
+
 /* Button configuration */
 #define ESP_INTR_FLAG_DEFAULT 0
 
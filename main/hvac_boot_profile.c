@@ -0,0 +1,123 @@
+/*
+ * HVAC Boot Phase Profiling Implementation
+ */
+
+#include "hvac_boot_profile.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include <string.h>
+
+static const char *TAG = "HVAC_BOOT";
+
+static const char *const phase_names[HVAC_BOOT_PHASE_COUNT] = {
+    "app_main", "zb_init", "driver_ready", "ac_synced", "zb_started", "network_up", "first_report",
+};
+
+#define BOOT_PROFILE_MAGIC  0x48424F54  // "HBOT"
+
+/* RTC memory: survives software resets, lost on power-on */
+typedef struct {
+    uint32_t magic;
+    hvac_boot_profile_t current;
+    hvac_boot_profile_t previous;
+} hvac_boot_rtc_t;
+
+static RTC_NOINIT_ATTR hvac_boot_rtc_t rtc_profile;
+
+/**
+ * @brief Start the profile of this boot
+ */
+void hvac_boot_profile_start(void)
+{
+    if (rtc_profile.magic == BOOT_PROFILE_MAGIC) {
+        rtc_profile.previous = rtc_profile.current;
+    } else {
+        memset(&rtc_profile, 0, sizeof(rtc_profile));  // Power-on: RTC memory holds garbage
+        rtc_profile.magic = BOOT_PROFILE_MAGIC;
+    }
+
+    uint32_t boot_count = rtc_profile.previous.boot_count + 1;
+    memset(&rtc_profile.current, 0, sizeof(rtc_profile.current));
+    rtc_profile.current.boot_count = boot_count;
+    rtc_profile.current.reset_reason = (uint8_t)esp_reset_reason();
+
+    hvac_boot_mark(HVAC_BOOT_APP_MAIN);
+}
+
+/**
+ * @brief Timestamp a boot phase
+ */
+void hvac_boot_mark(hvac_boot_phase_t phase)
+{
+    if (phase >= HVAC_BOOT_PHASE_COUNT || rtc_profile.current.phase_ms[phase] != 0) {
+        return;
+    }
+
+    // Never store 0: it means "not reached"
+    uint32_t ms = (uint32_t)(esp_timer_get_time() / 1000);
+    rtc_profile.current.phase_ms[phase] = ms ? ms : 1;
+    ESP_LOGI(TAG, "[BOOT] %s at %lu ms", phase_names[phase], (unsigned long)ms);
+
+    if (phase == HVAC_BOOT_FIRST_REPORT) {
+        const hvac_boot_profile_t *prev = &rtc_profile.previous;
+        ESP_LOGI(TAG, "[BOOT] Boot #%lu (reset reason %u): first report %lu ms after reset",
+                 (unsigned long)rtc_profile.current.boot_count, rtc_profile.current.reset_reason,
+                 (unsigned long)ms);
+        if (prev->boot_count != 0) {
+            ESP_LOGI(TAG, "[BOOT] Previous boot (reset reason %u): network_up %lu ms, first_report %lu ms",
+                     prev->reset_reason,
+                     (unsigned long)prev->phase_ms[HVAC_BOOT_NETWORK_UP],
+                     (unsigned long)prev->phase_ms[HVAC_BOOT_FIRST_REPORT]);
+        }
+    }
+}
+
+/**
+ * @brief Copy the profiles of this boot and the previous one
+ */
+esp_err_t hvac_boot_profile_get(hvac_boot_profile_t *current, hvac_boot_profile_t *previous)
+{
+    if (current) {
+        *current = rtc_profile.current;
+    }
+    if (previous) {
+        *previous = rtc_profile.previous;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Write one profile: reset reason, boot count, phase times
+ */
+static uint8_t *hvac_boot_profile_put(uint8_t *p, const hvac_boot_profile_t *profile)
+{
+    *p++ = profile->reset_reason;
+    for (int i = 0; i < 4; i++) {
+        *p++ = (profile->boot_count >> (8 * i)) & 0xFF;
+    }
+    for (size_t phase = 0; phase < HVAC_BOOT_PHASE_COUNT; phase++) {
+        for (int i = 0; i < 4; i++) {
+            *p++ = (profile->phase_ms[phase] >> (8 * i)) & 0xFF;
+        }
+    }
+    return p;
+}
+
+/**
+ * @brief Serialize both profiles for an octet string attribute
+ */
+size_t hvac_boot_profile_serialize(uint8_t *buf, size_t len)
+{
+    if (!buf || len < HVAC_BOOT_SERIALIZED_LEN) {
+        return 0;
+    }
+
+    uint8_t *p = buf;
+    *p++ = HVAC_BOOT_SERIALIZED_VERSION;
+    *p++ = HVAC_BOOT_PHASE_COUNT;
+    p = hvac_boot_profile_put(p, &rtc_profile.current);
+    p = hvac_boot_profile_put(p, &rtc_profile.previous);
+    return p - buf;
+}
@@ -0,0 +1,88 @@
+/*
+ * HVAC Boot Phase Profiling Header
+ *
+ * Records when each boot phase is first reached, in ms since reset, in RTC
+ * memory that survives software resets (panic, watchdog, OTA restart). The
+ * timeline of the previous boot is kept next to the current one, so a boot
+ * that never reached the network can still be inspected after the restart.
+ *
+ * Phases (normally reached in this order; driver and Zigbee phases overlap):
+ *   APP_MAIN      - app_main() entered
+ *   ZB_INIT       - Zigbee stack initialized, driver init task started
+ *   DRIVER_READY  - UART/NVS/journal initialized
+ *   AC_SYNCED     - AC state read and reconciled with the persisted settings
+ *   ZB_STARTED    - Zigbee stack started (esp_zb_start() returned)
+ *   NETWORK_UP    - joined or rejoined the network
+ *   FIRST_REPORT  - first attribute push with real AC state after NETWORK_UP
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HVAC_BOOT_APP_MAIN = 0,
+    HVAC_BOOT_ZB_INIT,
+    HVAC_BOOT_DRIVER_READY,
+    HVAC_BOOT_AC_SYNCED,
+    HVAC_BOOT_ZB_STARTED,
+    HVAC_BOOT_NETWORK_UP,
+    HVAC_BOOT_FIRST_REPORT,
+    HVAC_BOOT_PHASE_COUNT
+} hvac_boot_phase_t;
+
+/* Serialized profile: version, phase count, reset reason and boot count of
+ * the current and previous boot, then uint32 LE ms per phase (current boot,
+ * then previous boot; 0 = not reached) */
+#define HVAC_BOOT_SERIALIZED_VERSION    1
+#define HVAC_BOOT_SERIALIZED_LEN        (2 + 2 * (1 + 4 + HVAC_BOOT_PHASE_COUNT * 4))
+
+typedef struct {
+    uint32_t boot_count;                        // Boots since RTC memory was last lost (power cycle)
+    uint8_t reset_reason;                       // esp_reset_reason_t of this boot
+    uint32_t phase_ms[HVAC_BOOT_PHASE_COUNT];   // ms since reset, 0 = not reached
+} hvac_boot_profile_t;
+
+/**
+ * @brief Start the profile of this boot
+ *
+ * Moves the RTC record of the last boot to the "previous" slot and marks
+ * APP_MAIN. Call first thing in app_main().
+ */
+void hvac_boot_profile_start(void);
+
+/**
+ * @brief Timestamp a boot phase (only the first call per phase counts)
+ *
+ * @param phase Phase reached
+ */
+void hvac_boot_mark(hvac_boot_phase_t phase);
+
+/**
+ * @brief Copy the profiles of this boot and the previous one
+ *
+ * @param current Destination for this boot (may be NULL)
+ * @param previous Destination for the previous boot (may be NULL, zeroed if unknown)
+ * @return ESP_OK on success
+ */
+esp_err_t hvac_boot_profile_get(hvac_boot_profile_t *current, hvac_boot_profile_t *previous);
+
+/**
+ * @brief Serialize both profiles for an octet string attribute
+ *
+ * @param buf Destination, at least HVAC_BOOT_SERIALIZED_LEN bytes
+ * @param len Size of buf
+ * @return Number of bytes written, 0 if buf is too small
+ */
+size_t hvac_boot_profile_serialize(uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
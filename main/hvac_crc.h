@@ -0,0 +1,53 @@
+/*
+ * HVAC Frame CRC
+ * 
+ * CRC16 (Modbus polynomial 0xA001, init 0xFFFF) used by ACW02 frames.
+ * Plain C with no ESP-IDF dependencies so it can be built on the host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* CRC16 implementation, selectable at build time (e.g. -DHVAC_CRC16_IMPL=1):
+ *   BITWISE - 8 shift/xor iterations per byte, no table
+ *   NIBBLE  - 2 lookups per byte in a 16-entry table (32 bytes of flash)
+ *   TABLE   - 1 lookup per byte in a 256-entry table (512 bytes of flash)
+ */
+#define HVAC_CRC16_IMPL_BITWISE     0
+#define HVAC_CRC16_IMPL_NIBBLE      1
+#define HVAC_CRC16_IMPL_TABLE       2
+
+#ifndef HVAC_CRC16_IMPL
+#define HVAC_CRC16_IMPL HVAC_CRC16_IMPL_TABLE
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Calculate CRC16 for HVAC frames
+ * 
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ * @return CRC16 value (transmitted MSB first at the end of the frame)
+ */
+uint16_t hvac_crc16(const uint8_t *data, size_t len);
+
+/**
+ * @brief Continue a CRC16 over another chunk (for frames split across a ring wrap)
+ * 
+ * hvac_crc16(data, len) == hvac_crc16_update(0xFFFF, data, len)
+ * 
+ * @param crc Running CRC value (0xFFFF to start)
+ * @param data Bytes to checksum
+ * @param len Number of bytes
+ * @return Updated CRC16 value
+ */
+uint16_t hvac_crc16_update(uint16_t crc, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
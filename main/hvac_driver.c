@@ -5,8 +5,16 @@
  */
 
 #include "hvac_driver.h"
+#include "hvac_crc.h"
+#include "hvac_frame_parser.h"
+#include "hvac_latency.h"
+#include "hvac_error_codes.h"
+#include "hvac_journal.h"
+#include "hvac_boot_profile.h"
+#include "hvac_shadow_tracker.h"
 #include "esp_log.h"
 #include "string.h"
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -14,6 +22,8 @@
 #include "driver/gpio.h"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
 
 static const char *TAG = "HVAC_DRIVER";
 static const char *NVS_NAMESPACE = "hvac_storage";
@@ -21,152 +31,202 @@ static const char *NVS_NAMESPACE = "hvac_storage";
 /* State change callback */
 static hvac_state_change_callback_t state_change_callback = NULL;
 
-/* Mutex protecting current_state across tasks */
+/* Mutex serializing writers of current_state (RX decode, hvac_apply) */
 static SemaphoreHandle_t state_mutex = NULL;
 
-/* Error code mapping structure */
-typedef struct {
-    uint8_t code_high;  // High byte (ASCII character like 'E', 'P', 'U', etc.)
-    uint8_t code_low;   // Low byte (ASCII digit like '0', '1', etc.)
-    const char *description;
-} error_code_entry_t;
-
-/* Error code lookup table from AIRTON-LIST-ERROR-CODE.EN.pdf */
-static const error_code_entry_t error_code_table[] = {
-    {'C', 'L', "Filter cleaning reminder"},
-    {'D', '0', "Compressor RMS phase current limit"},
-    {'D', '1', "Low RMS machine current limit"},
-    {'D', '2', "Lower gas discharge temperature limit"},
-    {'D', '3', "Extreme anti-freeze limit"},
-    {'D', '4', "Overload limit"},
-    {'D', '5', "IPM power module temperature limit"},
-    {'E', '0', "Protection against high discharge temperatures"},
-    {'E', '1', "Overload protection"},
-    {'E', '2', "Compressor overload protection"},
-    {'E', '3', "Frost protection"},
-    {'E', '7', "4-way valve malfunction"},
-    {'E', '8', "Abnormal outdoor ambient temperature"},
-    {'H', '0', "Compressor stalling or jamming"},
-    {'H', '1', "Startup failure"},
-    {'H', '2', "Compressor phase current peak protection"},
-    {'H', '3', "Compressor phase current RMS protection"},
-    {'H', '4', "IPM power module protection"},
-    {'H', '5', "IPM overheat protection"},
-    {'H', '6', "Compressor circuit phase detection error"},
-    {'H', '7', "Compressor phase loss error"},
-    {'H', '8', "Outdoor unit fan motor error"},
-    {'H', '9', "Outdoor unit fan motor phase current detection circuit error"},
-    {'L', '0', "Jumper error"},
-    {'L', '1', "Indoor fan motor zero crossing detection circuit malfunction"},
-    {'L', '2', "Indoor fan motor error"},
-    {'L', '3', "Communication fault between indoor and outdoor unit"},
-    {'L', '4', "Port selection error"},
-    {'L', '5', "EEPROM error on indoor unit"},
-    {'L', '6', "Communication fault between outdoor and indoor unit"},
-    {'L', 'L', "Function test"},
-    {'P', '0', "EEPROM error on outdoor unit"},
-    {'P', '1', "Power on error"},
-    {'P', '2', "AC current protection"},
-    {'P', '3', "High voltage protection"},
-    {'P', '4', "Low voltage protection"},
-    {'P', '5', "DC DC line voltage drop protection"},
-    {'P', '6', "Current detection circuit error"},
-    {'P', '7', "Overcurrent protection"},
-    {'P', '8', "PFC current detection circuit error"},
-    {'P', '9', "PFC protection"},
-    {'P', 'A', "IU and EU mismatch"},
-    {'P', 'C', "Fashion Conflict"},
-    {'U', '0', "Ambient temperature sensor (probe) open/closed circuit"},
-    {'U', '1', "Pipe temperature sensor (probe) open/closed circuit"},
-    {'U', '2', "Ambient temperature sensor (probe) open/closed circuit"},
-    {'U', '3', "UE Discharge Sensor (Probe) Open/Closed Circuit"},
-    {'U', '4', "UE pipe temperature sensor open/closed circuit (probe)"},
-    {'U', '5', "IPM power module temperature sensor open/closed circuit"},
-    {'U', '6', "Liquid pipe outlet temperature sensor open/closed circuit"},
-    {'U', '7', "Gas pipe outlet temperature sensor open/closed circuit"},
-    {'U', '8', "Discharge temperature sensor open/closed circuit"},
-};
-
-#define ERROR_CODE_TABLE_SIZE (sizeof(error_code_table) / sizeof(error_code_entry_t))
-
-/* Decode error code to human-readable text */
-static const char* hvac_decode_error_code(uint8_t code) {
-    // Handle special case for filter cleaning (0x80)
-    if (code == 0x80) {
-        return "Filter cleaning reminder (CL)";
-    }
-    
-    // Handle standard two-byte error codes
-    // The code format appears to be: high nibble = letter, low nibble = digit
-    // For example: E1 might be encoded differently
-    
-    // Try to decode assuming ASCII-like encoding
-    uint8_t code_high = (code >> 4) & 0x0F;
-    uint8_t code_low = code & 0x0F;
-    
-    // Convert nibbles to ASCII characters
-    char high_char = 0, low_char = 0;
-    
-    // Map high nibble to letter (rough approximation - may need adjustment based on actual protocol)
-    if (code_high >= 0x0C && code_high <= 0x0F) {
-        high_char = 'C' + (code_high - 0x0C);  // C, D, E, F
-    } else if (code_high >= 0x08 && code_high <= 0x0B) {
-        high_char = 'H' + (code_high - 0x08);  // H, I, J, K
-    } else if (code_high >= 0x04 && code_high <= 0x07) {
-        high_char = 'L' + (code_high - 0x04);  // L, M, N, O
-    } else if (code_high <= 0x03) {  // 0x00-0x03
-        high_char = 'P' + (code_high - 0x00);  // P, Q, R, S
-    }
-    
-    // Map low nibble to digit or letter
-    if (code_low <= 9) {
-        low_char = '0' + code_low;
-    } else {
-        low_char = 'A' + (code_low - 10);  // A=10, B=11, C=12, etc.
-    }
-    
-    // Search in lookup table
-    for (size_t i = 0; i < ERROR_CODE_TABLE_SIZE; i++) {
-        if (error_code_table[i].code_high == high_char && 
-            error_code_table[i].code_low == low_char) {
-            return error_code_table[i].description;
-        }
-    }
-    
-    // If not found in table, return unknown with hex code
-    static char unknown_buffer[32];
-    snprintf(unknown_buffer, sizeof(unknown_buffer), "Unknown error code 0x%02X", code);
-    return unknown_buffer;
-}
+/* Lock-free publication of current_state for readers.
+ * A writer (holding state_mutex) copies current_state into the slot readers
+ * are not using, then switches state_snapshot_idx. Each slot has a sequence
+ * counter that is odd while the slot is being written, so a reader preempted
+ * across two publications sees the counter move and retries. Readers never
+ * block, and since writers only touch the inactive slot a reader that
+ * preempts a writer always finds a stable snapshot. */
+static hvac_state_t state_snapshot[2];
+static atomic_uint state_snapshot_seq[2];
+static atomic_uint state_snapshot_idx;
+static atomic_uint snapshot_reads;
+static atomic_uint snapshot_retries;
+static atomic_uint writer_waits;
 
 /* Current HVAC state */
 static hvac_state_t current_state = {
+    .flags = HVAC_STATE_DISPLAY,    // Power off, display on, no error
     .mode = HVAC_MODE_COOL,
-    .power_on = false,
-    .target_temp_c = 24,
-    .ambient_temp_c = 25,
-    .eco_mode = false,
-    .night_mode = false,
-    .display_on = true,
-    .swing_on = false,
-    .purifier_on = false,
-    .clean_status = false,
-    .mute_on = false,
     .fan_speed = HVAC_FAN_AUTO,
-    .error = false,
-    .error_text = ""  // Empty string when no error
+    .target_temp_cd = 2400,
+    .ambient_temp_cd = 2500,
+};
+
+/* Desired/reported shadow (guarded by state_mutex).
+ * current_state is what the AC last reported; desired_state is the last
+ * request. Published state is current_state with the shadow_tracker.pending
+ * fields taken from desired_state (see hvac_shadow_view()). */
+static hvac_state_t desired_state;
+static hvac_shadow_tracker_t shadow_tracker;
+
+/* Last state the state change callback was told about */
+static hvac_state_t notified_state;
+
+/* current_state holds a decoded 34-byte status (not just NVS defaults) */
+static bool status_confirmed = false;
+
+/* Boot: 1 = read the AC state first and send the persisted settings only if
+ * they differ (no beep when nothing changed), 0 = always send them */
+#ifndef HVAC_BOOT_RECONCILE
+#define HVAC_BOOT_RECONCILE         1
+#endif
+#define HVAC_BOOT_STATUS_TIMEOUT_MS 1500    // Wait for the first status frame before falling back
+
+/* Boot-to-synchronized time (guarded by state_mutex) */
+static bool boot_sync_pending = false;      // Persisted settings sent at boot, not confirmed yet
+static uint32_t boot_sync_ms = 0;           // Time since boot when the AC matched (0 = not yet)
+
+/* Status frame bookkeeping for hvac_refresh_state() */
+static atomic_uint status_generation;               // Bumped for every decoded 34-byte frame
+static atomic_uint status_time_ms;                  // When the last one was decoded (wraps, use differences)
+static TaskHandle_t status_waiters[HVAC_REFRESH_MAX_WAITERS];  // Tasks blocked in hvac_refresh_state()
+static portMUX_TYPE status_waiters_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Streaming frame parser - owns the RX ring the UART is read into */
+static hvac_frame_parser_t rx_parser;
+
+// Ambient temperature filter (written under state_mutex)
+static hvac_ambient_filter_t ambient_filter = {
+    .deadband_cd = HVAC_AMBIENT_DEADBAND_CD_DEFAULT,
+    .ema_shift = HVAC_AMBIENT_EMA_SHIFT_DEFAULT,
 };
+static int32_t ambient_ema_q4;      // EMA accumulator in 1/16 centi-degree
+static bool ambient_ema_seeded = false;
+
+/* UART event queue - RX task blocks here until the driver reports data */
+static QueueHandle_t uart_event_queue = NULL;
+#define HVAC_UART_EVENT_QUEUE_LEN   20
+
+/* RX timeout in symbol times (1 symbol = 10 bits = ~1.04 ms at 9600 baud).
+ * The UART raises UART_DATA as soon as the line has been idle this long,
+ * which is the inter-frame gap of the ACW02 protocol. */
+#define HVAC_UART_RX_TOUT_SYMBOLS   3
+#define HVAC_UART_SYMBOL_US         (10 * 1000000 / HVAC_UART_BAUD_RATE)
+
+/* Previous polling RX path: 10 ms silence gap + 20 ms read timeout (lower bound) */
+#define HVAC_LEGACY_RX_LATENCY_US   30000
+
+/* TX path - every frame goes through tx_queue and is written by hvac_tx_task,
+ * which only paces frames and never blocks on an answer. A control frame is
+ * acknowledged by the first 34-byte status frame that starts after it was
+ * written; the RX task times that round trip. Re-sending a control frame the
+ * AC has not applied is left to the shadow (hvac_shadow_check()). A control
+ * frame queued after another one carries the complete newer state and
+ * supersedes it. */
+typedef enum {
+    HVAC_TX_CONTROL = 0,    // 24-byte command frame, acknowledged by a status frame
+    HVAC_TX_STATUS_REQUEST,
+    HVAC_TX_KEEPALIVE,
+} hvac_tx_kind_t;
+
+typedef struct {
+    uint8_t data[24];
+    uint8_t len;
+    hvac_tx_kind_t kind;
+    uint32_t seq;           // Control frame sequence number (supersede check)
+} hvac_tx_item_t;
+
+#define HVAC_TX_QUEUE_LEN           8
+#define HVAC_TX_MIN_GAP_MS          100     // Minimum idle time between two frames on the wire
+#define HVAC_TX_ACK_TIMEOUT_MS      HVAC_SHADOW_RESEND_MS   // Later status frames do not count as an ack
+
+/* Command task: runs hvac_apply() for callers that must not block (Zigbee stack task) */
+#define HVAC_CMD_QUEUE_LEN          8
+
+static QueueHandle_t cmd_queue = NULL;
+static TaskHandle_t cmd_task_handle = NULL;
 
-/* UART buffer */
-static uint8_t rx_buffer[HVAC_UART_BUF_SIZE];
-static size_t rx_buffer_len = 0;
-static uint32_t last_rx_time = 0;
+static QueueHandle_t tx_queue = NULL;
+static volatile uint32_t tx_control_seq = 0;   // Sequence of the newest queued control frame
+static volatile uint32_t tx_control_done = 0;  // Sequence of the last control frame the TX task handled
+static hvac_tx_stats_t tx_stats = {0};
+
+/* Control frame written and not acknowledged yet (TX task writes, RX task acks) */
+static bool tx_ack_pending = false;
+static int64_t tx_ack_written_us = 0;          // End of the write on the wire
+static portMUX_TYPE tx_ack_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Time the UART driver reported the end of the frame currently being decoded */
+static int64_t rx_event_time_us = 0;
+
+/* A 34-byte status frame plus the RX idle timeout, from first bit to UART event */
+#define HVAC_STATUS_FRAME_US        ((34 + HVAC_UART_RX_TOUT_SYMBOLS) * HVAC_UART_SYMBOL_US)
+static hvac_rx_stats_t rx_stats = {0};
 
 /* Delayed NVS write to reduce flash wear */
 static TimerHandle_t nvs_save_timer = NULL;
 static bool nvs_save_pending = false;
 #define NVS_SAVE_DELAY_MS  900000  // 900 seconds - write to flash once per 15 minutes max
 
+/* Persisted settings: one CRC-protected blob under NVS_SETTINGS_KEY.
+ * Bump HVAC_SETTINGS_VERSION when the layout changes and migrate the old
+ * layout in hvac_load_settings(). */
+#define NVS_SETTINGS_KEY        "settings"
+#define HVAC_SETTINGS_VERSION   1
+#define HVAC_SETTINGS_FLAGS     (HVAC_STATE_POWER | HVAC_STATE_ECO | HVAC_STATE_NIGHT | \
+                                 HVAC_STATE_DISPLAY | HVAC_STATE_SWING | HVAC_STATE_PURIFIER | \
+                                 HVAC_STATE_MUTE)
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;            // HVAC_SETTINGS_VERSION
+    uint8_t mode;
+    uint8_t fan_speed;
+    uint8_t ambient_ema_shift;
+    uint16_t flags;             // HVAC_SETTINGS_FLAGS bits
+    int16_t target_temp_cd;
+    uint16_t ambient_deadband_cd;
+    uint16_t crc;               // hvac_crc16() over the preceding bytes
+} hvac_settings_blob_t;
+
+/* Persistence counters, stored under NVS_WEAR_KEY with every settings commit */
+#define NVS_WEAR_KEY                "wear"
+#define NVS_ENTRIES_PER_PAGE        126     // 4 KB page minus header and entry bitmap, 32 B entries
+#define NVS_ENTRIES_PER_COMMIT      6       // Settings and wear blobs: index + header + 1 data entry each
+
+typedef struct __attribute__((packed)) {
+    uint32_t commits;
+    uint32_t skipped;
+    uint32_t entries_written;
+    uint16_t crc;               // hvac_crc16() over the preceding bytes
+} hvac_wear_blob_t;
+
+static hvac_wear_blob_t nvs_wear;
+
+/* Image of the settings blob currently in flash (valid once loaded or written) */
+static hvac_settings_blob_t persisted_settings;
+static bool persisted_settings_valid = false;
+
+/* Settings journal: every change is made durable at once in a dedicated
+ * partition (see partitions.csv). NVS stays the fallback for partition
+ * tables without it (OTA cannot add a partition). */
+#define HVAC_JOURNAL_PARTITION_LABEL    "hvac_jrnl"
+#define HVAC_JOURNAL_PARTITION_SUBTYPE  0x40
+
+/* Journal keys, one per settings blob field */
+enum {
+    HVAC_JKEY_MODE = 0,
+    HVAC_JKEY_FAN,
+    HVAC_JKEY_FLAGS,
+    HVAC_JKEY_TARGET,
+    HVAC_JKEY_AMBIENT_DEADBAND,
+    HVAC_JKEY_AMBIENT_EMA,
+};
+
+static hvac_journal_t journal;
+static bool journal_mounted = false;
+static SemaphoreHandle_t journal_mutex = NULL;
+
+/* Keys written by released firmware before the settings blob (migrated, then erased) */
+static const char *const legacy_settings_keys[] = {
+    "mode", "power", "temp", "fan", "eco", "night", "display",
+    "swing", "purifier", "mute",
+};
+
 /* Keepalive frame */
 static const uint8_t keepalive_frame[] = {
     0x7A, 0x7A, 0x21, 0xD5, 0x0C, 0x00, 0x00, 0xAB,
@@ -188,33 +248,99 @@ static const uint8_t get_status_frame[] = {
 // };
 
 /* Forward declarations */
-static uint16_t hvac_crc16(const uint8_t *data, size_t len);
-static uint8_t hvac_encode_temperature(uint8_t temp_c);
-static esp_err_t hvac_send_frame(const uint8_t *data, size_t len);
-static esp_err_t hvac_build_and_send_command(void);
-static void hvac_decode_state(const uint8_t *frame, size_t len);
+static uint8_t hvac_encode_temperature(int16_t temp_cd);
+static esp_err_t hvac_send_frame(const uint8_t *data, size_t len, hvac_tx_kind_t kind);
+#define HVAC_CONTROL_FRAME_LEN      24
+
+static void hvac_encode_command(const hvac_state_t *state, uint8_t frame[HVAC_CONTROL_FRAME_LEN]);
+static esp_err_t hvac_build_and_send_command(const hvac_state_t *state);
+static void hvac_decode_state(const hvac_frame_view_t *frame);
 static void hvac_rx_task(void *arg);
-static esp_err_t hvac_save_settings_immediate(void);  // Actual NVS write
-static void nvs_save_timer_callback(TimerHandle_t xTimer);  // Delayed write callback
+static void hvac_tx_task(void *arg);
+static void hvac_cmd_task(void *arg);
+static void hvac_shadow_check(void);
+static esp_err_t hvac_save_settings(void);
+static void hvac_rx_record_latency(void);
+static int16_t hvac_filter_ambient(int16_t raw_cd);
+
+/**
+ * @brief Take state_mutex for writing, counting the times a writer had to wait
+ */
+static void hvac_state_lock(void)
+{
+    if (xSemaphoreTake(state_mutex, 0) != pdTRUE) {
+        atomic_fetch_add_explicit(&writer_waits, 1, memory_order_relaxed);
+        xSemaphoreTake(state_mutex, portMAX_DELAY);
+    }
+}
+
+/**
+ * @brief Reported state with the unconfirmed requested fields overlaid (caller holds state_mutex)
+ */
+static void hvac_shadow_view(hvac_state_t *view)
+{
+    uint32_t pending = shadow_tracker.pending;
+
+    *view = current_state;
+    if (pending == 0) {
+        return;
+    }
+
+    uint32_t flag_mask = pending & 0xFFFFu;  // HVAC_STATE_* bits live in the low half
+    view->flags = (view->flags & ~flag_mask) | (desired_state.flags & flag_mask) | HVAC_STATE_PENDING;
+    if (pending & HVAC_DIRTY_MODE) view->mode = desired_state.mode;
+    if (pending & HVAC_DIRTY_FAN) view->fan_speed = desired_state.fan_speed;
+    if (pending & HVAC_DIRTY_TARGET) view->target_temp_cd = desired_state.target_temp_cd;
+}
+
+/**
+ * @brief Record that the AC and the persisted settings agree after boot (caller holds state_mutex)
+ */
+static void hvac_boot_synced(const char *how)
+{
+    boot_sync_pending = false;
+    boot_sync_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    hvac_boot_mark(HVAC_BOOT_AC_SYNCED);
+    ESP_LOGI(TAG, "Boot synchronized with AC %lu ms after reset (%s)", (unsigned long)boot_sync_ms, how);
+}
+
+/**
+ * @brief Publish the shadow view of current_state to readers (caller holds state_mutex)
+ */
+static void hvac_state_publish(void)
+{
+    unsigned int next = atomic_load_explicit(&state_snapshot_idx, memory_order_relaxed) ^ 1;
+
+    atomic_fetch_add_explicit(&state_snapshot_seq[next], 1, memory_order_relaxed);  // Odd: being written
+    atomic_thread_fence(memory_order_release);
+    hvac_shadow_view(&state_snapshot[next]);
+    atomic_fetch_add_explicit(&state_snapshot_seq[next], 1, memory_order_release);  // Even: stable
+    atomic_store_explicit(&state_snapshot_idx, next, memory_order_release);
+}
 
 /**
- * @brief Calculate CRC16 for HVAC frames
- */
-static uint16_t hvac_crc16(const uint8_t *data, size_t len)
-{
-    uint16_t crc = 0xFFFF;
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (int j = 0; j < 8; j++) {
-            if (crc & 0x0001) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
+ * @brief Copy the latest published state without taking a lock
+ */
+static void hvac_state_read(hvac_state_t *state)
+{
+    atomic_fetch_add_explicit(&snapshot_reads, 1, memory_order_relaxed);
+
+    while (1) {
+        unsigned int idx = atomic_load_explicit(&state_snapshot_idx, memory_order_acquire);
+        unsigned int seq = atomic_load_explicit(&state_snapshot_seq[idx], memory_order_acquire);
+
+        if ((seq & 1) == 0) {
+            memcpy(state, &state_snapshot[idx], sizeof(*state));
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&state_snapshot_seq[idx], memory_order_relaxed) == seq) {
+                return;
             }
         }
+        atomic_fetch_add_explicit(&snapshot_retries, 1, memory_order_relaxed);
     }
-    return crc;
 }
+static esp_err_t hvac_save_settings_immediate(void);  // Actual NVS write
+static void nvs_save_timer_callback(TimerHandle_t xTimer);  // Delayed write callback
 
 /**
  * @brief Encode temperature to HVAC format
@@ -222,18 +348,18 @@ static uint16_t hvac_crc16(const uint8_t *data, size_t len)
  * IMPORTANT: The ACW02 appears to expect Celsius values directly, not Fahrenheit!
  * The encoding table was misleading - we should just send the Celsius value.
  */
-static uint8_t hvac_encode_temperature(uint8_t temp_c)
+static uint8_t hvac_encode_temperature(int16_t temp_cd)
 {
     // Clamp temperature to valid range (16-31°C)
-    if (temp_c < 16) temp_c = 16;
-    if (temp_c > 31) temp_c = 31;
+    if (temp_cd < HVAC_TEMP_MIN_CD) temp_cd = HVAC_TEMP_MIN_CD;
+    if (temp_cd > HVAC_TEMP_MAX_CD) temp_cd = HVAC_TEMP_MAX_CD;
     
     /* ACW02 Protocol temperature encoding (Celsius only):
      * - Frame byte value = actual_temp_celsius - 16
      * - Example: 24°C → frame byte = 24-16 = 0x08
      * - Range: 16-31°C → 0x00-0x0F in frame
      */
-    return temp_c - 16;
+    return (uint8_t)((temp_cd - HVAC_TEMP_MIN_CD) / 100);
 }
 
 /**
@@ -251,9 +377,9 @@ static uint8_t hvac_encode_temperature(uint8_t temp_c)
  * [17-21] Reserved: 0x00
  * [22-23] CRC16: MSB, LSB (computed over first 22 bytes)
  */
-static esp_err_t hvac_build_and_send_command(void)
+static void hvac_encode_command(const hvac_state_t *state, uint8_t frame[HVAC_CONTROL_FRAME_LEN])
 {
-    uint8_t frame[24] = {0};
+    memset(frame, 0, HVAC_CONTROL_FRAME_LEN);
     
     // Frame header (bytes 0-7)
     frame[0] = 0x7A;
@@ -268,35 +394,35 @@ static esp_err_t hvac_build_and_send_command(void)
     // Bytes 8-11 are reserved (already zeroed)
     
     // Byte 12: Pack fan (4 bits), power (1 bit), mode (3 bits)
-    uint8_t fan_nibble = ((uint8_t)current_state.fan_speed & 0x0F) << 4;
-    uint8_t power_bit = (current_state.power_on ? 1 : 0) << 3;
-    uint8_t mode_bits = (uint8_t)current_state.mode & 0x07;
+    uint8_t fan_nibble = ((uint8_t)state->fan_speed & 0x0F) << 4;
+    uint8_t power_bit = (hvac_state_has(state, HVAC_STATE_POWER) ? 1 : 0) << 3;
+    uint8_t mode_bits = (uint8_t)state->mode & 0x07;
     frame[12] = fan_nibble | power_bit | mode_bits;
     
     // Byte 13: Temperature encoding (with SILENT bit if needed)
-    uint8_t temp_base = hvac_encode_temperature(current_state.target_temp_c);
-    if (current_state.fan_speed == HVAC_FAN_SILENT) {
+    uint8_t temp_base = hvac_encode_temperature(state->target_temp_cd);
+    if (state->fan_speed == HVAC_FAN_SILENT) {
         frame[13] = temp_base + 0x40;  // Add SILENT bit
     } else {
         frame[13] = temp_base;
     }
     
     // Byte 14: Swing (horizontal in upper nibble, vertical in lower nibble)
-    uint8_t swing_v = current_state.swing_on ? 0x07 : 0x00;  // 0x07 = auto swing
+    uint8_t swing_v = hvac_state_has(state, HVAC_STATE_SWING) ? 0x07 : 0x00;  // 0x07 = auto swing
     uint8_t swing_h = 0x00;  // Horizontal swing (not used for now)
     frame[14] = (swing_h << 4) | swing_v;
     
     // Byte 15: Options byte
     uint8_t options = 0x00;
-    if (current_state.eco_mode) options |= 0x01;      // Bit 0: ECO mode
-    if (current_state.night_mode) options |= 0x02;    // Bit 1: NIGHT mode
+    if (hvac_state_has(state, HVAC_STATE_ECO)) options |= 0x01;      // Bit 0: ECO mode
+    if (hvac_state_has(state, HVAC_STATE_NIGHT)) options |= 0x02;    // Bit 1: NIGHT mode
     // clean mode: bit 0x10 (READ from AC, not sent TO AC)
-    if (current_state.purifier_on) options |= 0x40;   // Bit 6: PURIFIER mode
-    if (current_state.display_on) options |= 0x80;    // Bit 7: DISPLAY on/off
+    if (hvac_state_has(state, HVAC_STATE_PURIFIER)) options |= 0x40;   // Bit 6: PURIFIER mode
+    if (hvac_state_has(state, HVAC_STATE_DISPLAY)) options |= 0x80;    // Bit 7: DISPLAY on/off
     frame[15] = options;
     
     // Byte 16: Mute
-    frame[16] = current_state.mute_on ? 0x01 : 0x00;  // Bit 0: MUTE (silent command)
+    frame[16] = hvac_state_has(state, HVAC_STATE_MUTE) ? 0x01 : 0x00;  // Bit 0: MUTE (silent command)
     
     // Bytes 17-21 are reserved (already zeroed)
     
@@ -304,21 +430,72 @@ static esp_err_t hvac_build_and_send_command(void)
     uint16_t crc = hvac_crc16(frame, 22);
     frame[22] = (crc >> 8) & 0xFF;  // CRC MSB
     frame[23] = crc & 0xFF;          // CRC LSB
+}
+
+/**
+ * @brief Build and queue the control frame for a state
+ */
+static esp_err_t hvac_build_and_send_command(const hvac_state_t *state)
+{
+    uint8_t frame[HVAC_CONTROL_FRAME_LEN];
     
-    return hvac_send_frame(frame, sizeof(frame));
+    hvac_encode_command(state, frame);
+    return hvac_send_frame(frame, sizeof(frame), HVAC_TX_CONTROL);
+}
+
+/**
+ * @brief Queue a frame for the TX task
+ * 
+ * Never blocks the caller (typically the Zigbee stack thread).
+ */
+static esp_err_t hvac_send_frame(const uint8_t *data, size_t len, hvac_tx_kind_t kind)
+{
+    if (tx_queue == NULL || len > sizeof(((hvac_tx_item_t *)0)->data)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    hvac_tx_item_t item = {
+        .len = (uint8_t)len,
+        .kind = kind,
+    };
+    memcpy(item.data, data, len);
+
+    if (kind == HVAC_TX_CONTROL) {
+        item.seq = ++tx_control_seq;
+    }
+
+    if (xQueueSend(tx_queue, &item, 0) != pdTRUE) {
+        if (kind == HVAC_TX_CONTROL && tx_control_seq == item.seq) {
+            tx_control_seq = item.seq - 1;  // Never queued: must not supersede or count as in flight
+        }
+        tx_stats.queue_full++;
+        ESP_LOGW(TAG, "TX queue full - frame dropped");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
 }
 
 /**
- * @brief Send frame via UART
+ * @brief Write a frame to the UART, keeping HVAC_TX_MIN_GAP_MS since the previous one
  */
-static esp_err_t hvac_send_frame(const uint8_t *data, size_t len)
+static esp_err_t hvac_uart_transmit(const uint8_t *data, size_t len)
 {
+    static int64_t last_tx_end_us = 0;
+
+    int64_t gap_us = esp_timer_get_time() - last_tx_end_us;
+    if (gap_us < HVAC_TX_MIN_GAP_MS * 1000) {
+        vTaskDelay(pdMS_TO_TICKS(HVAC_TX_MIN_GAP_MS - gap_us / 1000) + 1);
+    }
+
     int written = uart_write_bytes(HVAC_UART_NUM, data, len);
     if (written < 0) {
         ESP_LOGE(TAG, "Failed to write to UART");
         return ESP_FAIL;
     }
-    
+    uart_wait_tx_done(HVAC_UART_NUM, pdMS_TO_TICKS(100));
+    last_tx_end_us = esp_timer_get_time();
+    tx_stats.frames_sent++;
+
     // Log full frame in hex for debugging
     char hex_str[256] = {0};
     char *ptr = hex_str;
@@ -326,10 +503,228 @@ static esp_err_t hvac_send_frame(const uint8_t *data, size_t len)
         ptr += sprintf(ptr, "%02X ", data[i]);
     }
     ESP_LOGI(TAG, "TX [%d bytes]: %s", len, hex_str);
-    
+
     return ESP_OK;
 }
 
+/**
+ * @brief Write a control frame and arm its acknowledgement
+ * 
+ * Does not wait for the AC: the RX task acknowledges the frame with the next
+ * status frame (hvac_tx_ack()), and the shadow re-sends it if the AC does
+ * not apply it.
+ */
+static void hvac_tx_control(const hvac_tx_item_t *item)
+{
+    tx_stats.control_frames++;
+
+    // A newer control frame is queued - it carries the complete state, skip this one
+    if (item->seq != tx_control_seq) {
+        tx_stats.superseded++;
+        ESP_LOGD(TAG, "Control frame #%lu superseded by #%lu",
+                 (unsigned long)item->seq, (unsigned long)tx_control_seq);
+        tx_control_done = item->seq;
+        return;
+    }
+
+    if (hvac_uart_transmit(item->data, item->len) == ESP_OK) {
+        hvac_latency_mark(HVAC_LAT_WIRE);
+
+        portENTER_CRITICAL(&tx_ack_lock);
+        if (tx_ack_pending) {
+            tx_stats.ack_timeouts++;    // The previous frame never got its status frame
+        }
+        tx_ack_pending = true;
+        tx_ack_written_us = esp_timer_get_time();
+        portEXIT_CRITICAL(&tx_ack_lock);
+    }
+    tx_control_done = item->seq;
+}
+
+/**
+ * @brief Check whether a control frame is queued or written but not answered yet
+ */
+static bool hvac_tx_control_in_flight(void)
+{
+    portENTER_CRITICAL(&tx_ack_lock);
+    bool in_flight = tx_ack_pending || tx_control_done != tx_control_seq;
+    portEXIT_CRITICAL(&tx_ack_lock);
+    return in_flight;
+}
+
+/**
+ * @brief Acknowledge the pending control frame with a status frame (RX task)
+ * 
+ * Only a status frame that started after the control frame was written
+ * counts: one already on the wire answers an earlier request.
+ * 
+ * @param frame_start_us Estimated time the first byte of the status frame arrived
+ */
+static void hvac_tx_ack(int64_t frame_start_us)
+{
+    portENTER_CRITICAL(&tx_ack_lock);
+    if (!tx_ack_pending || frame_start_us < tx_ack_written_us) {
+        portEXIT_CRITICAL(&tx_ack_lock);
+        return;
+    }
+    tx_ack_pending = false;
+    uint32_t rtt_us = (uint32_t)(esp_timer_get_time() - tx_ack_written_us);
+    if (rtt_us > HVAC_TX_ACK_TIMEOUT_MS * 1000) {
+        tx_stats.ack_timeouts++;
+    } else {
+        tx_stats.acked++;
+        tx_stats.last_rtt_us = rtt_us;
+        if (rtt_us > tx_stats.max_rtt_us) {
+            tx_stats.max_rtt_us = rtt_us;
+        }
+        tx_stats.total_rtt_us += rtt_us;
+    }
+    portEXIT_CRITICAL(&tx_ack_lock);
+
+    ESP_LOGD(TAG, "Control frame answered by a status frame after %lu us", (unsigned long)rtt_us);
+}
+
+/**
+ * @brief UART transmit task
+ *
+ * Serializes all frames to the AC and paces them by HVAC_TX_MIN_GAP_MS.
+ */
+static void hvac_tx_task(void *arg)
+{
+    hvac_tx_item_t item;
+
+    while (1) {
+        if (xQueueReceive(tx_queue, &item, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        if (item.kind == HVAC_TX_CONTROL) {
+            hvac_tx_control(&item);
+        } else {
+            hvac_uart_transmit(item.data, item.len);
+        }
+    }
+}
+
+/**
+ * @brief Re-send or roll back a request the AC has not confirmed in time
+ * 
+ * Runs on the command task, so convergence does not wait for the keepalive
+ * status poll.
+ */
+static void hvac_shadow_check(void)
+{
+    hvac_state_lock();
+
+    uint32_t pending = shadow_tracker.pending;
+    hvac_shadow_action_t action = hvac_shadow_track_poll(&shadow_tracker, esp_timer_get_time());
+    if (action == HVAC_SHADOW_WAIT) {
+        xSemaphoreGive(state_mutex);
+        return;
+    }
+
+    if (action == HVAC_SHADOW_RESEND) {
+        hvac_state_t view;
+        hvac_shadow_view(&view);
+        view.flags &= ~HVAC_STATE_PENDING;
+        uint8_t attempt = shadow_tracker.attempts;
+        xSemaphoreGive(state_mutex);
+
+        ESP_LOGW(TAG, "AC has not confirmed 0x%06lX - re-sending (attempt %d/%d)",
+                 (unsigned long)pending, attempt, HVAC_SHADOW_MAX_ATTEMPTS);
+        hvac_build_and_send_command(&view);
+        return;
+    }
+
+    // Give up: published state falls back to what the AC reports
+    if (boot_sync_pending) {
+        hvac_boot_synced("AC kept its own settings");
+    }
+    hvac_state_publish();
+
+    hvac_state_t view;
+    hvac_shadow_view(&view);
+    uint32_t changed = hvac_state_diff(&notified_state, &view);
+    notified_state = view;
+    xSemaphoreGive(state_mutex);
+
+    ESP_LOGW(TAG, "AC did not apply 0x%06lX after %d frames - rolled back to reported state",
+             (unsigned long)pending, HVAC_SHADOW_MAX_ATTEMPTS);
+    hvac_save_settings();
+    if (changed && state_change_callback) {
+        state_change_callback(changed);
+    }
+}
+
+/**
+ * @brief Wake the command task (queued change set or new pending request)
+ */
+static void hvac_cmd_task_wake(void)
+{
+    if (cmd_task_handle != NULL) {
+        xTaskNotifyGive(cmd_task_handle);
+    }
+}
+
+/**
+ * @brief Command task: applies change sets queued by hvac_apply_async()
+ * 
+ * Takes state_mutex, resets the NVS timer and queues the control frame on
+ * behalf of the caller. Also owns re-sends and rollbacks of every request,
+ * including those applied synchronously on other tasks: hvac_apply() wakes
+ * it whenever it leaves a request pending.
+ */
+static void hvac_cmd_task(void *arg)
+{
+    hvac_state_delta_t delta;
+
+    while (1) {
+        // Wake up periodically while a request waits for the AC to confirm it
+        hvac_state_lock();
+        TickType_t wait = shadow_tracker.pending ? pdMS_TO_TICKS(HVAC_SHADOW_POLL_MS) : portMAX_DELAY;
+        xSemaphoreGive(state_mutex);
+
+        ulTaskNotifyTake(pdTRUE, wait);
+        while (xQueueReceive(cmd_queue, &delta, 0) == pdTRUE) {
+            esp_err_t err = hvac_apply(&delta);
+            if (err != ESP_OK) {
+                ESP_LOGW(TAG, "Queued change 0x%03lX rejected: %s",
+                         (unsigned long)delta.fields, esp_err_to_name(err));
+            }
+        }
+        hvac_shadow_check();
+    }
+}
+
+/**
+ * @brief Smooth a raw ambient reading and apply the reporting deadband
+ * 
+ * The sensor reports 0.1°C steps and jitters between neighbouring values.
+ * Each jitter would otherwise set a dirty bit and cost a Zigbee report.
+ * Must be called with state_mutex held.
+ * 
+ * @param raw_cd Raw ambient temperature in 0.01°C
+ * @return Ambient temperature to publish in 0.01°C
+ */
+static int16_t hvac_filter_ambient(int16_t raw_cd)
+{
+    if (!ambient_ema_seeded) {
+        ambient_ema_q4 = (int32_t)raw_cd << 4;
+        ambient_ema_seeded = true;
+        return raw_cd;
+    }
+    
+    ambient_ema_q4 += (((int32_t)raw_cd << 4) - ambient_ema_q4) >> ambient_filter.ema_shift;
+    int16_t filtered = (int16_t)((ambient_ema_q4 + 8) >> 4);
+    
+    int32_t diff = filtered - current_state.ambient_temp_cd;
+    if (diff < 0) diff = -diff;
+    if (diff < ambient_filter.deadband_cd) {
+        return current_state.ambient_temp_cd;
+    }
+    return filtered;
+}
+
 /**
  * @brief Decode received HVAC state frame
  * 
@@ -342,89 +737,66 @@ static esp_err_t hvac_send_frame(const uint8_t *data, size_t len)
  * [15]   Swing: (horizontal<<4) | vertical
  * [16]   Options: eco(0x01) | night(0x02) | from_remote(0x04) | display(0x08) | clean(0x10) | purifier(0x40) | display(0x80)
  * [32-33] CRC16
+ * 
+ * Only called by the frame parser with a complete, CRC-checked frame. The
+ * frame is a view into the RX ring and may wrap, so bytes are read through
+ * hvac_frame_view_byte() rather than copied out.
  */
-static void hvac_decode_state(const uint8_t *frame, size_t len)
+static void hvac_decode_state(const hvac_frame_view_t *frame)
 {
-    if (len < 13) {
-        ESP_LOGW(TAG, "Frame too short: %d bytes", len);
-        return;
-    }
-    
-    // Verify header
-    if (frame[0] != 0x7A || frame[1] != 0x7A) {
-        ESP_LOGW(TAG, "Invalid frame header");
-        return;
-    }
+    size_t len = hvac_frame_view_len(frame);
+
+    // Header, length and CRC were already validated by the frame parser
     
     // Log full frame in hex for debugging
     char hex_str[256] = {0};
     char *ptr = hex_str;
     for (size_t i = 0; i < len && i < 64; i++) {
-        ptr += sprintf(ptr, "%02X ", frame[i]);
+        ptr += sprintf(ptr, "%02X ", hvac_frame_view_byte(frame, i));
     }
     ESP_LOGI(TAG, "RX [%d bytes]: %s", len, hex_str);
-    
-    // Verify CRC
-    uint16_t expected_crc = (frame[len - 2] << 8) | frame[len - 1];
-    uint16_t computed_crc = hvac_crc16(frame, len - 2);
-    
-    if (expected_crc != computed_crc) {
-        ESP_LOGW(TAG, "CRC mismatch: expected 0x%04X, got 0x%04X", expected_crc, computed_crc);
-        return;
-    }
-    
-    ESP_LOGI(TAG, "RX [%d bytes]: Valid frame received", len);
-
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
 
     // Handle 13-byte ACK frames from AC (acknowledgment of commands)
     // Frame structure: 7A 7A D1 21 0D 00 00 A4 0A 0A 00 CRC CRC
-    if (len == 13 && frame[0] == 0x7A && frame[1] == 0x7A && frame[2] == 0xD1 && frame[3] == 0x21) {
+    if (len == 13 && hvac_frame_view_byte(frame, 0) == 0x7A && hvac_frame_view_byte(frame, 1) == 0x7A && hvac_frame_view_byte(frame, 2) == 0xD1 && hvac_frame_view_byte(frame, 3) == 0x21) {
         ESP_LOGD(TAG, "ACK frame received from AC (13 bytes)");
         // This is just an acknowledgment, no state to decode
-        xSemaphoreGive(state_mutex);
         return;
     }
 
     // Handle 18-byte frames (if they exist)
-    if (len == 18 && frame[0] == 0x7A && frame[1] == 0x7A) {
+    if (len == 18 && hvac_frame_view_byte(frame, 0) == 0x7A && hvac_frame_view_byte(frame, 1) == 0x7A) {
         ESP_LOGD(TAG, "18-byte frame received (keepalive/other)");
         // Handle if needed in the future
-        xSemaphoreGive(state_mutex);
         return;
     }
     
     // Handle 28-byte warning/error frames
-    if (len == 28 && frame[0] == 0x7A && frame[1] == 0x7A && frame[2] == 0xD5 && frame[3] == 0x21) {
-        uint8_t warn = frame[10];
-        uint8_t fault = frame[12];
+    if (len == 28 && hvac_frame_view_byte(frame, 0) == 0x7A && hvac_frame_view_byte(frame, 1) == 0x7A && hvac_frame_view_byte(frame, 2) == 0xD5 && hvac_frame_view_byte(frame, 3) == 0x21) {
+        uint8_t warn = hvac_frame_view_byte(frame, 10);
+        uint8_t fault = hvac_frame_view_byte(frame, 12);
         
+        hvac_state_lock();
+        // Only the raw codes are kept; the text is resolved by hvac_format_error_text()
         if (fault != 0x00) {
-            // We only know that 0x04 = PC (Fashion Conflict)
-            // All other fault codes are unknown
-            current_state.error = true;
-            current_state.clean_status = false;
-            if (fault == 0x04) {
-                ESP_LOGE(TAG, "AC FAULT: code=0x%02X - PC: Fashion Conflict", fault);
-                snprintf(current_state.error_text, sizeof(current_state.error_text),
-                         "FAULT 0x%02X: PC - Fashion Conflict", fault);
-            } else {
-                ESP_LOGE(TAG, "AC FAULT: code=0x%02X - Unknown error", fault);
-                snprintf(current_state.error_text, sizeof(current_state.error_text),
-                         "Error, check error code on the display");
-            }
+            ESP_LOGE(TAG, "AC FAULT: code=0x%02X%s", fault, fault == 0x04 ? " - PC: Fashion Conflict" : " - Unknown error");
+            hvac_state_set(&current_state, HVAC_STATE_ERROR, true);
+            hvac_state_set(&current_state, HVAC_STATE_CLEAN, false);
+            current_state.fault_code = fault;
+            current_state.warn_code = warn;
         } else if (warn != 0x00) {
-            const char *warn_desc = hvac_decode_error_code(warn);
-            ESP_LOGW(TAG, "AC WARNING: code=0x%02X - %s", warn, warn_desc);
-            current_state.error = false;
-            snprintf(current_state.error_text, sizeof(current_state.error_text),
-                     "WARNING 0x%02X: %s", warn, warn_desc);
-            current_state.clean_status = (warn == 0x80);  // Filter needs cleaning only for 0x80
+            ESP_LOGW(TAG, "AC WARNING: code=0x%02X (%s) - %s", warn, hvac_error_code_name(warn), hvac_error_code_text(warn));
+            hvac_state_set(&current_state, HVAC_STATE_ERROR, false);
+            hvac_state_set(&current_state, HVAC_STATE_CLEAN, warn == 0x80);  // Filter needs cleaning only for 0x80
+            current_state.fault_code = 0;
+            current_state.warn_code = warn;
         } else {
-            current_state.clean_status = false;  // No warnings - filter is clean
-            current_state.error = false;
-            current_state.error_text[0] = '\0';  // Empty string when no error
+            hvac_state_set(&current_state, HVAC_STATE_CLEAN, false);  // No warnings - filter is clean
+            hvac_state_set(&current_state, HVAC_STATE_ERROR, false);
+            current_state.fault_code = 0;
+            current_state.warn_code = 0;
         }
+        hvac_state_publish();
         xSemaphoreGive(state_mutex);
         return;
     }
@@ -432,27 +804,28 @@ static void hvac_decode_state(const uint8_t *frame, size_t len)
     // Parse 34-byte status frames
     if (len != 34) {
         ESP_LOGW(TAG, "Unexpected frame length (expected 34 bytes, got %d)", len);
-        xSemaphoreGive(state_mutex);
         return;
     }
     
     ESP_LOGI(TAG, "Parsing 34-byte status frame...");
     
+    hvac_state_lock();
+    
     // Parse ambient temperature (bytes 10-11)
-    uint8_t temp_int = frame[10];
-    uint8_t temp_dec = frame[11];
+    uint8_t temp_int = hvac_frame_view_byte(frame, 10);
+    uint8_t temp_dec = hvac_frame_view_byte(frame, 11);
     
-    // Calculate with explicit types to avoid truncation
-    current_state.ambient_temp_c = (float)temp_int + ((float)temp_dec / 10.0f);
+    // Integer centi-degrees (ZCL unit) - no float on the RX path
+    current_state.ambient_temp_cd = hvac_filter_ambient((int16_t)(temp_int * 100 + temp_dec * 10));
     
     // Byte 13: Power, Mode, Fan
-    uint8_t b13 = frame[13];
-    current_state.power_on = (b13 & 0x08) != 0;
+    uint8_t b13 = hvac_frame_view_byte(frame, 13);
+    hvac_state_set(&current_state, HVAC_STATE_POWER, (b13 & 0x08) != 0);
     current_state.mode = (hvac_mode_t)(b13 & 0x07);
     current_state.fan_speed = (hvac_fan_t)((b13 >> 4) & 0x0F);
     
     // Byte 14: Temperature (with SILENT bit in bit 6)
-    uint8_t temp_byte = frame[14];
+    uint8_t temp_byte = hvac_frame_view_byte(frame, 14);
     bool silent_bit = (temp_byte & 0x40) != 0;
     temp_byte &= 0x3F;  // Mask to get 6-bit temperature value (0-63 range)
     
@@ -464,14 +837,14 @@ static void hvac_decode_state(const uint8_t *frame, size_t len)
      * Note: Fahrenheit uses special encoding table (not implemented - AC typically in Celsius)
      */
     if (temp_byte <= 15) {
-        current_state.target_temp_c = 16 + temp_byte;  // 0-15 → 16-31°C
+        current_state.target_temp_cd = HVAC_TEMP_MIN_CD + temp_byte * 100;  // 0-15 → 16-31°C
     } else {
         // Value out of normal Celsius range - clamp to valid range
         ESP_LOGW(TAG, "Unexpected temperature byte value: 0x%02X (expected 0-15), clamping", temp_byte);
-        current_state.target_temp_c = (temp_byte > 15) ? 31 : 16;
+        current_state.target_temp_cd = HVAC_TEMP_MAX_CD;
     }
     
-    ESP_LOGD(TAG, "Temperature: frame_byte=0x%02X, decoded=%d°C", temp_byte, current_state.target_temp_c);
+    ESP_LOGD(TAG, "Temperature: frame_byte=0x%02X, decoded=%d°C", temp_byte, current_state.target_temp_cd / 100);
     
     // Override fan if SILENT bit is set
     if (silent_bit) {
@@ -479,60 +852,77 @@ static void hvac_decode_state(const uint8_t *frame, size_t len)
     }
     
     // Byte 15: Swing
-    uint8_t swing_raw = frame[15];
+    uint8_t swing_raw = hvac_frame_view_byte(frame, 15);
     uint8_t swing_v = swing_raw & 0x0F;
-    current_state.swing_on = (swing_v != 0);
+    hvac_state_set(&current_state, HVAC_STATE_SWING, swing_v != 0);
     
     // Byte 16: Options
-    uint8_t flags = frame[16];
-    current_state.eco_mode = (flags & 0x01) != 0;       // Bit 0: ECO mode
-    current_state.night_mode = (flags & 0x02) != 0;     // Bit 1: NIGHT mode
-    current_state.clean_status = (flags & 0x10) != 0;   // Bit 4: CLEAN status (from AC)
-    current_state.purifier_on = (flags & 0x40) != 0;    // Bit 6: PURIFIER mode
-    current_state.display_on = (flags & 0x80) != 0;     // Bit 7: DISPLAY on/off
-    
-    ESP_LOGI(TAG, "Decoded state: Power=%s, Mode=%d, Fan=0x%02X, Temp=%d°C, Ambient=%.1f°C", 
-             current_state.power_on ? "ON" : "OFF",
+    uint8_t flags = hvac_frame_view_byte(frame, 16);
+    hvac_state_set(&current_state, HVAC_STATE_ECO, (flags & 0x01) != 0);       // Bit 0: ECO mode
+    hvac_state_set(&current_state, HVAC_STATE_NIGHT, (flags & 0x02) != 0);     // Bit 1: NIGHT mode
+    hvac_state_set(&current_state, HVAC_STATE_CLEAN, (flags & 0x10) != 0);   // Bit 4: CLEAN status (from AC)
+    hvac_state_set(&current_state, HVAC_STATE_PURIFIER, (flags & 0x40) != 0);    // Bit 6: PURIFIER mode
+    hvac_state_set(&current_state, HVAC_STATE_DISPLAY, (flags & 0x80) != 0);     // Bit 7: DISPLAY on/off
+    
+    ESP_LOGI(TAG, "Decoded state: Power=%s, Mode=%d, Fan=0x%02X, Temp=%d°C, Ambient=%d.%d°C", 
+             hvac_state_has(&current_state, HVAC_STATE_POWER) ? "ON" : "OFF",
              current_state.mode,
              current_state.fan_speed,
-             current_state.target_temp_c,
-             current_state.ambient_temp_c);
+             current_state.target_temp_cd / 100,
+             current_state.ambient_temp_cd / 100, (current_state.ambient_temp_cd % 100) / 10);
     ESP_LOGI(TAG, "  Options: Eco=%s, Night=%s, Display=%s, Purifier=%s, Clean=%s, Swing=%s", 
-             current_state.eco_mode ? "ON" : "OFF",
-             current_state.night_mode ? "ON" : "OFF",
-             current_state.display_on ? "ON" : "OFF",
-             current_state.purifier_on ? "ON" : "OFF",
-             current_state.clean_status ? "YES" : "NO",
-             current_state.swing_on ? "ON" : "OFF");
+             hvac_state_has(&current_state, HVAC_STATE_ECO) ? "ON" : "OFF",
+             hvac_state_has(&current_state, HVAC_STATE_NIGHT) ? "ON" : "OFF",
+             hvac_state_has(&current_state, HVAC_STATE_DISPLAY) ? "ON" : "OFF",
+             hvac_state_has(&current_state, HVAC_STATE_PURIFIER) ? "ON" : "OFF",
+             hvac_state_has(&current_state, HVAC_STATE_CLEAN) ? "YES" : "NO",
+             hvac_state_has(&current_state, HVAC_STATE_SWING) ? "ON" : "OFF");
+    
+    status_confirmed = true;
+    
+    // Fields that now match the request are confirmed; a field changed again
+    // by the remote since the request keeps the reported value
+    if (hvac_shadow_track_report(&shadow_tracker, hvac_state_diff(&current_state, &desired_state))) {
+        ESP_LOGI(TAG, "Requested state confirmed by AC after %d frame(s)", shadow_tracker.attempts);
+        if (boot_sync_pending) {
+            hvac_boot_synced("persisted settings applied");
+        }
+    }
+    
+    hvac_state_publish();
+    
+    // Wake tasks waiting for fresh state before the (possibly slow) callback runs
+    atomic_store(&status_time_ms, (unsigned int)(esp_timer_get_time() / 1000));
+    atomic_fetch_add(&status_generation, 1);
+    portENTER_CRITICAL(&status_waiters_lock);
+    for (int i = 0; i < HVAC_REFRESH_MAX_WAITERS; i++) {
+        if (status_waiters[i]) {
+            xTaskNotifyGive(status_waiters[i]);
+        }
+    }
+    portEXIT_CRITICAL(&status_waiters_lock);
+    
+    // A status frame sent after the last control frame acknowledges it
+    hvac_latency_mark(HVAC_LAT_DECODED);
+    hvac_tx_ack(rx_event_time_us - HVAC_STATUS_FRAME_US);
     
     /* Notify Zigbee layer only if state actually changed (prevents excessive Zigbee traffic) */
-    static hvac_state_t prev_state = {0};
-    bool state_changed = false;
-    
-    // Check if any relevant state has changed
-    if (prev_state.power_on != current_state.power_on ||
-        prev_state.mode != current_state.mode ||
-        prev_state.fan_speed != current_state.fan_speed ||
-        prev_state.target_temp_c != current_state.target_temp_c ||
-        prev_state.ambient_temp_c != current_state.ambient_temp_c ||
-        prev_state.eco_mode != current_state.eco_mode ||
-        prev_state.night_mode != current_state.night_mode ||
-        prev_state.display_on != current_state.display_on ||
-        prev_state.purifier_on != current_state.purifier_on ||
-        prev_state.clean_status != current_state.clean_status ||
-        prev_state.swing_on != current_state.swing_on ||
-        prev_state.mute_on != current_state.mute_on ||
-        prev_state.error != current_state.error ||
-        strcmp(prev_state.error_text, current_state.error_text) != 0) {
-        state_changed = true;
-    }
-    
-    if (state_changed) {
-        ESP_LOGI(TAG, "State change detected - notifying Zigbee");
-        prev_state = current_state;  // Save current state for next comparison
+    hvac_state_t view;
+    hvac_shadow_view(&view);
+    
+    // Per-field dirty mask so the Zigbee layer only rewrites what moved.
+    // The first status frame refreshes everything (attributes still hold cluster defaults).
+    static bool first_status = true;
+    uint32_t changed = first_status ? HVAC_DIRTY_ALL : hvac_state_diff(&notified_state, &view);
+    first_status = false;
+    
+    if (changed) {
+        ESP_LOGI(TAG, "State change detected (0x%06lX) - notifying Zigbee", (unsigned long)changed);
+        notified_state = view;  // Save current state for next comparison
         xSemaphoreGive(state_mutex);
         if (state_change_callback) {
-            state_change_callback();
+            hvac_rx_record_latency();
+            state_change_callback(changed);
         }
     } else {
         ESP_LOGD(TAG, "No state change - skipping Zigbee update");
@@ -540,86 +930,105 @@ static void hvac_decode_state(const uint8_t *frame, size_t len)
     }
 }
 
+/**
+ * @brief Record wire-to-callback latency for the frame being decoded
+ *
+ * The UART driver raises UART_DATA once the line has been idle for
+ * HVAC_UART_RX_TOUT_SYMBOLS, so the last byte left the wire that long
+ * before rx_event_time_us.
+ */
+static void hvac_rx_record_latency(void)
+{
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - rx_event_time_us) +
+                          HVAC_UART_RX_TOUT_SYMBOLS * HVAC_UART_SYMBOL_US;
+
+    rx_stats.callbacks++;
+    rx_stats.last_latency_us = latency_us;
+    if (latency_us > rx_stats.max_latency_us) {
+        rx_stats.max_latency_us = latency_us;
+    }
+    rx_stats.total_latency_us += latency_us;
+    if (latency_us < HVAC_LEGACY_RX_LATENCY_US) {
+        rx_stats.saved_us_total += HVAC_LEGACY_RX_LATENCY_US - latency_us;
+    }
+
+    ESP_LOGD(TAG, "RX latency: %lu us wire->callback (avg %lu us, saved %llu ms total vs polling)",
+             (unsigned long)latency_us,
+             (unsigned long)(rx_stats.total_latency_us / rx_stats.callbacks),
+             (unsigned long long)(rx_stats.saved_us_total / 1000));
+}
+
+/**
+ * @brief Frame parser handler - called once per CRC-valid frame
+ */
+static void hvac_rx_frame_handler(const hvac_frame_view_t *frame, void *ctx)
+{
+    rx_stats.frames_decoded++;
+    hvac_decode_state(frame);
+}
+
 /**
  * @brief UART receive task
+ *
+ * Blocks on the UART driver event queue. UART_DATA is raised on RX timeout
+ * (inter-frame gap) or FIFO threshold, so frames are decoded as soon as
+ * the hardware sees the end of them instead of on a polling tick.
  */
 static void hvac_rx_task(void *arg)
 {
-    static const size_t VALID_SIZES[] = {13, 18, 28, 34};
-    static const size_t NUM_VALID_SIZES = sizeof(VALID_SIZES) / sizeof(VALID_SIZES[0]);
-    
+    uart_event_t event;
+
     while (1) {
-        // Safety check: ensure buffer has space
-        size_t space_available = HVAC_UART_BUF_SIZE - rx_buffer_len;
-        if (space_available < 34) {  // Need at least space for largest frame
-            ESP_LOGW(TAG, "HVAC RX buffer nearly full, resetting");
-            rx_buffer_len = 0;
-            space_available = HVAC_UART_BUF_SIZE;
-        }
-        
-        int len = uart_read_bytes(HVAC_UART_NUM, rx_buffer + rx_buffer_len, 
-                                  space_available, 20 / portTICK_PERIOD_MS);
-        
-        if (len > 0) {
-            rx_buffer_len += len;
-            last_rx_time = xTaskGetTickCount();
-        } else if (len < 0) {
-            // UART error occurred
-            ESP_LOGE(TAG, "HVAC UART read error: %d", len);
-            uart_flush_input(HVAC_UART_NUM);
-            rx_buffer_len = 0;
+        if (xQueueReceive(uart_event_queue, &event, portMAX_DELAY) != pdTRUE) {
+            continue;
         }
-        
-        // Process buffer if we have data and silence period
-        if (rx_buffer_len > 0 && (xTaskGetTickCount() - last_rx_time) > pdMS_TO_TICKS(10)) {
-            size_t offset = 0;
-            
-            while (offset < rx_buffer_len && rx_buffer_len - offset >= 13) {
-                bool found = false;
-                
-                for (size_t i = 0; i < NUM_VALID_SIZES; i++) {
-                    size_t frame_size = VALID_SIZES[i];
-                    
-                    if (offset + frame_size > rx_buffer_len) {
-                        continue;
-                    }
-                    
-                    // Check for valid frame header
-                    if (rx_buffer[offset] == 0x7A && rx_buffer[offset + 1] == 0x7A) {
-                        // Verify CRC
-                        uint16_t expected_crc = (rx_buffer[offset + frame_size - 2] << 8) | 
-                                                rx_buffer[offset + frame_size - 1];
-                        uint16_t computed_crc = hvac_crc16(&rx_buffer[offset], frame_size - 2);
-                        
-                        if (expected_crc == computed_crc) {
-                            // Valid frame found
-                            hvac_decode_state(&rx_buffer[offset], frame_size);
-                            offset += frame_size;
-                            found = true;
-                            break;
-                        }
+
+        switch (event.type) {
+        case UART_DATA: {
+            rx_event_time_us = esp_timer_get_time();
+
+            size_t buffered = 0;
+            uart_get_buffered_data_len(HVAC_UART_NUM, &buffered);
+            while (buffered > 0) {
+                // Read straight into the free span of the parser ring (no intermediate buffer)
+                uint8_t *dst;
+                size_t span = hvac_frame_parser_write_span(&rx_parser, &dst);
+                size_t to_read = buffered < span ? buffered : span;
+                int len = uart_read_bytes(HVAC_UART_NUM, dst, to_read, 0);
+                if (len <= 0) {
+                    if (len < 0) {
+                        // UART error occurred
+                        ESP_LOGE(TAG, "HVAC UART read error: %d", len);
+                        uart_flush_input(HVAC_UART_NUM);
+                        hvac_frame_parser_reset(&rx_parser);
                     }
+                    break;
                 }
-                
-                if (!found) {
-                    offset++;
-                }
-            }
-            
-            // Remove processed bytes
-            if (offset > 0) {
-                memmove(rx_buffer, rx_buffer + offset, rx_buffer_len - offset);
-                rx_buffer_len -= offset;
-            }
-            
-            // Additional safety: prevent buffer overflow
-            if (rx_buffer_len > HVAC_UART_BUF_SIZE - 64) {
-                ESP_LOGW(TAG, "HVAC RX buffer unexpectedly full (%zu bytes), resetting", rx_buffer_len);
-                rx_buffer_len = 0;
+                buffered -= len;
+                hvac_frame_parser_commit(&rx_parser, len);
             }
+            break;
+        }
+
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            ESP_LOGW(TAG, "HVAC UART %s - flushing input",
+                     event.type == UART_FIFO_OVF ? "FIFO overflow" : "ring buffer full");
+            rx_stats.uart_overflows++;
+            uart_flush_input(HVAC_UART_NUM);
+            xQueueReset(uart_event_queue);
+            hvac_frame_parser_reset(&rx_parser);
+            break;
+
+        case UART_FRAME_ERR:
+        case UART_PARITY_ERR:
+            ESP_LOGW(TAG, "HVAC UART %s error", event.type == UART_FRAME_ERR ? "frame" : "parity");
+            break;
+
+        default:
+            ESP_LOGD(TAG, "HVAC UART event type: %d", event.type);
+            break;
         }
-        
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
 }
 
@@ -635,6 +1044,50 @@ static void nvs_save_timer_callback(TimerHandle_t xTimer)
     }
 }
 
+/**
+ * @brief Pack the persisted part of a state (and the ambient filter) into a settings blob
+ */
+static void hvac_settings_pack(const hvac_state_t *state, hvac_settings_blob_t *blob)
+{
+    memset(blob, 0, sizeof(*blob));
+    blob->version = HVAC_SETTINGS_VERSION;
+    blob->mode = state->mode;
+    blob->fan_speed = state->fan_speed;
+    blob->ambient_ema_shift = ambient_filter.ema_shift;
+    blob->flags = (uint16_t)(state->flags & HVAC_SETTINGS_FLAGS);
+    blob->target_temp_cd = state->target_temp_cd;
+    blob->ambient_deadband_cd = ambient_filter.deadband_cd;
+    blob->crc = hvac_crc16((const uint8_t *)blob, offsetof(hvac_settings_blob_t, crc));
+}
+
+/**
+ * @brief Write a settings blob and the wear counters, and commit
+ */
+static esp_err_t hvac_settings_write(nvs_handle_t nvs_handle, const hvac_settings_blob_t *blob)
+{
+    esp_err_t err = nvs_set_blob(nvs_handle, NVS_SETTINGS_KEY, blob, sizeof(*blob));
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    // Count this commit in the same write, so the counters cost no extra commit
+    hvac_wear_blob_t wear = nvs_wear;
+    wear.commits++;
+    wear.entries_written += NVS_ENTRIES_PER_COMMIT;
+    wear.crc = hvac_crc16((const uint8_t *)&wear, offsetof(hvac_wear_blob_t, crc));
+    nvs_set_blob(nvs_handle, NVS_WEAR_KEY, &wear, sizeof(wear));
+    
+    err = nvs_commit(nvs_handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    
+    nvs_wear = wear;
+    persisted_settings = *blob;
+    persisted_settings_valid = true;
+    return ESP_OK;
+}
+
 /**
  * @brief Save HVAC settings to NVS immediately (internal function)
  */
@@ -642,6 +1095,19 @@ static esp_err_t hvac_save_settings_immediate(void)
 {
     nvs_handle_t nvs_handle;
     esp_err_t err;
+    hvac_state_t state;
+    
+    // Persist the published state: requested values win over not-yet-confirmed reports
+    hvac_state_read(&state);
+    
+    // Nothing to do if flash already holds these settings (e.g. a toggle and back)
+    hvac_settings_blob_t blob;
+    hvac_settings_pack(&state, &blob);
+    if (persisted_settings_valid && memcmp(&blob, &persisted_settings, sizeof(blob)) == 0) {
+        nvs_wear.skipped++;
+        ESP_LOGI(TAG, "Settings unchanged, NVS write skipped (%lu skipped)", (unsigned long)nvs_wear.skipped);
+        return ESP_OK;
+    }
     
     // Open NVS
     err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
@@ -650,39 +1116,147 @@ static esp_err_t hvac_save_settings_immediate(void)
         return err;
     }
     
-    // Save all settings
-    nvs_set_u8(nvs_handle, "mode", (uint8_t)current_state.mode);
-    nvs_set_u8(nvs_handle, "power", current_state.power_on ? 1 : 0);
-    nvs_set_u8(nvs_handle, "temp", current_state.target_temp_c);
-    nvs_set_u8(nvs_handle, "fan", (uint8_t)current_state.fan_speed);
-    nvs_set_u8(nvs_handle, "eco", current_state.eco_mode ? 1 : 0);
-    nvs_set_u8(nvs_handle, "night", current_state.night_mode ? 1 : 0);
-    nvs_set_u8(nvs_handle, "display", current_state.display_on ? 1 : 0);
-    nvs_set_u8(nvs_handle, "swing", current_state.swing_on ? 1 : 0);
-    nvs_set_u8(nvs_handle, "purifier", current_state.purifier_on ? 1 : 0);
-    nvs_set_u8(nvs_handle, "mute", current_state.mute_on ? 1 : 0);
+    // Save all settings as one blob
+    err = hvac_settings_write(nvs_handle, &blob);
+    nvs_close(nvs_handle);
     
-    // Commit changes
-    err = nvs_commit(nvs_handle);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Failed to save settings: %s", esp_err_to_name(err));
     } else {
-        ESP_LOGI(TAG, "Settings saved to NVS");
+        ESP_LOGI(TAG, "Settings saved to NVS (%lu commits, %lu skipped)",
+                 (unsigned long)nvs_wear.commits, (unsigned long)nvs_wear.skipped);
     }
-    
-    nvs_close(nvs_handle);
     return err;
 }
 
+static int hvac_journal_flash_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    return esp_partition_read((const esp_partition_t *)ctx, offset, buf, len);
+}
+
+static int hvac_journal_flash_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    return esp_partition_write((const esp_partition_t *)ctx, offset, buf, len);
+}
+
+static int hvac_journal_flash_erase(void *ctx, uint32_t offset)
+{
+    return esp_partition_erase_range((const esp_partition_t *)ctx, offset, HVAC_JOURNAL_SECTOR_SIZE);
+}
+
+/**
+ * @brief Mount the settings journal and apply its values over the NVS settings
+ */
+static void hvac_journal_init(void)
+{
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           HVAC_JOURNAL_PARTITION_SUBTYPE,
+                                                           HVAC_JOURNAL_PARTITION_LABEL);
+    if (part == NULL) {
+        ESP_LOGW(TAG, "No '%s' partition - settings are saved to NVS only", HVAC_JOURNAL_PARTITION_LABEL);
+        return;
+    }
+    
+    journal_mutex = xSemaphoreCreateMutex();
+    if (journal_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create journal mutex");
+        return;
+    }
+    
+    hvac_journal_flash_t flash = {
+        .read = hvac_journal_flash_read,
+        .write = hvac_journal_flash_write,
+        .erase_sector = hvac_journal_flash_erase,
+        .ctx = (void *)part,
+        .size = part->size,
+    };
+    int64_t start_us = esp_timer_get_time();
+    if (!hvac_journal_mount(&journal, &flash)) {
+        ESP_LOGE(TAG, "Failed to mount settings journal");
+        return;
+    }
+    journal_mounted = true;
+    
+    // The journal is never older than NVS: its values win
+    uint32_t value;
+    if (hvac_journal_get(&journal, HVAC_JKEY_MODE, &value)) {
+        current_state.mode = (hvac_mode_t)value;
+    }
+    if (hvac_journal_get(&journal, HVAC_JKEY_FAN, &value)) {
+        current_state.fan_speed = (hvac_fan_t)value;
+    }
+    if (hvac_journal_get(&journal, HVAC_JKEY_FLAGS, &value)) {
+        current_state.flags = (current_state.flags & ~HVAC_SETTINGS_FLAGS) | (value & HVAC_SETTINGS_FLAGS);
+    }
+    if (hvac_journal_get(&journal, HVAC_JKEY_TARGET, &value)) {
+        current_state.target_temp_cd = (int16_t)value;
+    }
+    if (hvac_journal_get(&journal, HVAC_JKEY_AMBIENT_DEADBAND, &value) && value <= HVAC_AMBIENT_DEADBAND_CD_MAX) {
+        ambient_filter.deadband_cd = (uint16_t)value;
+    }
+    if (hvac_journal_get(&journal, HVAC_JKEY_AMBIENT_EMA, &value) && value <= HVAC_AMBIENT_EMA_SHIFT_MAX) {
+        ambient_filter.ema_shift = (uint8_t)value;
+    }
+    
+    ESP_LOGI(TAG, "Settings journal replayed in %lld us: sector %lu seq %lu, %lu records, %lu torn",
+             esp_timer_get_time() - start_us,
+             (unsigned long)journal.active_sector, (unsigned long)journal.seq,
+             (unsigned long)journal.stats.records_replayed, (unsigned long)journal.stats.torn_records);
+}
+
 /**
- * @brief Schedule delayed save to NVS (reduces flash wear)
+ * @brief Append the persisted fields of a state that changed to the journal
+ * 
+ * The fields go in as one change set, so a power cut never replays a mix
+ * of old and new settings.
  * 
- * This function marks settings as pending and starts/resets a timer.
- * The actual write to NVS happens after NVS_SAVE_DELAY_MS milliseconds
- * of no further changes, reducing flash wear significantly.
+ * @return true if the state is durable in the journal
+ */
+static bool hvac_journal_record(const hvac_state_t *state)
+{
+    if (!journal_mounted) {
+        return false;
+    }
+    
+    hvac_settings_blob_t blob;
+    hvac_settings_pack(state, &blob);
+    
+    const hvac_journal_entry_t entries[] = {
+        { HVAC_JKEY_MODE, blob.mode },
+        { HVAC_JKEY_FAN, blob.fan_speed },
+        { HVAC_JKEY_FLAGS, blob.flags },
+        { HVAC_JKEY_TARGET, (uint16_t)blob.target_temp_cd },
+        { HVAC_JKEY_AMBIENT_DEADBAND, blob.ambient_deadband_cd },
+        { HVAC_JKEY_AMBIENT_EMA, blob.ambient_ema_shift },
+    };
+    
+    xSemaphoreTake(journal_mutex, portMAX_DELAY);
+    bool ok = hvac_journal_set_many(&journal, entries, sizeof(entries) / sizeof(entries[0]));
+    xSemaphoreGive(journal_mutex);
+    
+    if (!ok) {
+        ESP_LOGE(TAG, "Settings journal write failed - falling back to the delayed NVS save");
+    }
+    return ok;
+}
+
+/**
+ * @brief Persist the current settings
+ * 
+ * With the journal partition the change is durable right away and NVS is
+ * not touched: the journal wins at boot anyway. Without it (or if the
+ * journal write fails) settings are marked pending and a timer is
+ * started/reset; the NVS write happens after NVS_SAVE_DELAY_MS of no
+ * further changes, reducing flash wear significantly.
  */
 static esp_err_t hvac_save_settings(void)
 {
+    hvac_state_t state;
+    hvac_state_read(&state);
+    if (hvac_journal_record(&state)) {
+        return ESP_OK;
+    }
+    
     // Mark that we have pending changes
     nvs_save_pending = true;
     
@@ -713,65 +1287,203 @@ static esp_err_t hvac_save_settings(void)
 }
 
 /**
- * @brief Load HVAC settings from NVS
+ * @brief Load settings saved as separate keys by older firmware
+ * 
+ * @return true if any legacy key was found
  */
-static esp_err_t hvac_load_settings(void)
+static bool hvac_load_legacy_settings(nvs_handle_t nvs_handle)
 {
-    nvs_handle_t nvs_handle;
-    esp_err_t err;
-    
-    // Open NVS
-    err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "No saved settings found, using defaults");
-        } else {
-            ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
-        }
-        return err;
-    }
-    
-    // Load all settings
+    bool found = false;
     uint8_t val;
     
     if (nvs_get_u8(nvs_handle, "mode", &val) == ESP_OK) {
         current_state.mode = (hvac_mode_t)val;
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "power", &val) == ESP_OK) {
-        current_state.power_on = (val != 0);
+        hvac_state_set(&current_state, HVAC_STATE_POWER, val != 0);
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "temp", &val) == ESP_OK) {
-        current_state.target_temp_c = val;
+        current_state.target_temp_cd = val * 100;  // Whole degrees
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "fan", &val) == ESP_OK) {
         current_state.fan_speed = (hvac_fan_t)val;
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "eco", &val) == ESP_OK) {
-        current_state.eco_mode = (val != 0);
+        hvac_state_set(&current_state, HVAC_STATE_ECO, val != 0);
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "night", &val) == ESP_OK) {
-        current_state.night_mode = (val != 0);
+        hvac_state_set(&current_state, HVAC_STATE_NIGHT, val != 0);
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "display", &val) == ESP_OK) {
-        current_state.display_on = (val != 0);
+        hvac_state_set(&current_state, HVAC_STATE_DISPLAY, val != 0);
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "swing", &val) == ESP_OK) {
-        current_state.swing_on = (val != 0);
+        hvac_state_set(&current_state, HVAC_STATE_SWING, val != 0);
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "purifier", &val) == ESP_OK) {
-        current_state.purifier_on = (val != 0);
+        hvac_state_set(&current_state, HVAC_STATE_PURIFIER, val != 0);
+        found = true;
     }
     if (nvs_get_u8(nvs_handle, "mute", &val) == ESP_OK) {
-        current_state.mute_on = (val != 0);
+        hvac_state_set(&current_state, HVAC_STATE_MUTE, val != 0);
+        found = true;
     }
     
-    ESP_LOGI(TAG, "Settings loaded from NVS: Mode=%d, Power=%d, Temp=%d°C",
-             current_state.mode, current_state.power_on, current_state.target_temp_c);
+    return found;
+}
+
+/**
+ * @brief Rewrite legacy keys as a settings blob and erase them
+ */
+static esp_err_t hvac_migrate_legacy_settings(nvs_handle_t nvs_handle)
+{
+    hvac_settings_blob_t blob;
+    hvac_settings_pack(&current_state, &blob);
     
+    // Blob first: a power loss before the erase leaves both, and the blob wins
+    esp_err_t err = hvac_settings_write(nvs_handle, &blob);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to migrate settings: %s", esp_err_to_name(err));
+        return err;
+    }
+    
+    for (size_t i = 0; i < sizeof(legacy_settings_keys) / sizeof(legacy_settings_keys[0]); i++) {
+        nvs_erase_key(nvs_handle, legacy_settings_keys[i]);  // ESP_ERR_NVS_NOT_FOUND is fine
+    }
+    return nvs_commit(nvs_handle);
+}
+
+/**
+ * @brief Load HVAC settings from NVS
+ * 
+ * Reads the settings blob; if there is none, loads the legacy per-field keys
+ * and migrates them to a blob.
+ */
+static esp_err_t hvac_load_settings(void)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t err;
+    int64_t start_us = esp_timer_get_time();
+    
+    // Open NVS (read-write: migration rewrites legacy keys)
+    err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(err));
+        return err;
+    }
+    
+    // Wear counters first: migration below already counts as a commit
+    hvac_wear_blob_t wear;
+    size_t wear_len = sizeof(wear);
+    if (nvs_get_blob(nvs_handle, NVS_WEAR_KEY, &wear, &wear_len) == ESP_OK && wear_len == sizeof(wear) &&
+        wear.crc == hvac_crc16((const uint8_t *)&wear, offsetof(hvac_wear_blob_t, crc))) {
+        nvs_wear = wear;
+    }
+    
+    hvac_settings_blob_t blob;
+    size_t len = sizeof(blob);
+    err = nvs_get_blob(nvs_handle, NVS_SETTINGS_KEY, &blob, &len);
+    if (err == ESP_OK && len == sizeof(blob) && blob.version == HVAC_SETTINGS_VERSION &&
+        blob.crc == hvac_crc16((const uint8_t *)&blob, offsetof(hvac_settings_blob_t, crc))) {
+        current_state.mode = (hvac_mode_t)blob.mode;
+        current_state.fan_speed = (hvac_fan_t)blob.fan_speed;
+        current_state.flags = (current_state.flags & ~HVAC_SETTINGS_FLAGS) |
+                              (blob.flags & HVAC_SETTINGS_FLAGS);
+        current_state.target_temp_cd = blob.target_temp_cd;
+        if (blob.ambient_deadband_cd <= HVAC_AMBIENT_DEADBAND_CD_MAX) {
+            ambient_filter.deadband_cd = blob.ambient_deadband_cd;
+        }
+        if (blob.ambient_ema_shift <= HVAC_AMBIENT_EMA_SHIFT_MAX) {
+            ambient_filter.ema_shift = blob.ambient_ema_shift;
+        }
+        persisted_settings = blob;
+        persisted_settings_valid = true;
+    } else if (err == ESP_ERR_NVS_NOT_FOUND) {
+        if (hvac_load_legacy_settings(nvs_handle)) {
+            ESP_LOGI(TAG, "Migrating legacy NVS keys to settings blob v%d", HVAC_SETTINGS_VERSION);
+            hvac_migrate_legacy_settings(nvs_handle);
+        } else {
+            ESP_LOGI(TAG, "No saved settings found, using defaults");
+        }
+    } else {
+        // Wrong size, unknown version or bad CRC: keep defaults, the next save replaces it
+        ESP_LOGW(TAG, "Settings blob invalid (%s, %u bytes, v%u), using defaults",
+                 esp_err_to_name(err), (unsigned)len, blob.version);
+    }
+    
+    size_t used_entries = 0;
+    nvs_get_used_entry_count(nvs_handle, &used_entries);
     nvs_close(nvs_handle);
+    
+    ESP_LOGI(TAG, "Settings loaded from NVS in %lld us (%u entries): Mode=%d, Power=%d, Temp=%d°C",
+             esp_timer_get_time() - start_us, (unsigned)used_entries,
+             current_state.mode, hvac_state_has(&current_state, HVAC_STATE_POWER), current_state.target_temp_cd / 100);
     return ESP_OK;
 }
 
+/**
+ * @brief Bring the AC and the persisted settings together at boot
+ * 
+ * The AC may have been changed by its IR remote while we were off, so its
+ * state is read first. The persisted settings then go through hvac_apply(),
+ * which suppresses the control frame (and the beep) when the AC already
+ * matches, and otherwise tracks the request until the AC confirms it.
+ * hvac_apply() wakes the command task for a pending request, so a lost
+ * frame is re-sent and the boot ends synchronized or rolled back.
+ */
+static void hvac_boot_reconcile(const hvac_state_t *persisted)
+{
+    hvac_send_keepalive();
+    
+    esp_err_t err = hvac_refresh_state(HVAC_BOOT_STATUS_TIMEOUT_MS);
+    if (err != ESP_OK) {
+        // No answer: fall back to pushing the persisted settings blind
+        ESP_LOGW(TAG, "[HVAC] No status from AC within %d ms (%s), sending persisted settings",
+                 HVAC_BOOT_STATUS_TIMEOUT_MS, esp_err_to_name(err));
+        hvac_build_and_send_command(persisted);
+        return;
+    }
+    
+    hvac_state_delta_t delta = {
+        .fields = HVAC_FIELD_POWER | HVAC_FIELD_MODE | HVAC_FIELD_TEMP | HVAC_FIELD_FAN |
+                  HVAC_FIELD_ECO | HVAC_FIELD_NIGHT | HVAC_FIELD_DISPLAY | HVAC_FIELD_SWING |
+                  HVAC_FIELD_PURIFIER | HVAC_FIELD_MUTE,
+        .power_on = hvac_state_has(persisted, HVAC_STATE_POWER),
+        .mode = (hvac_mode_t)persisted->mode,
+        .target_temp_cd = persisted->target_temp_cd,
+        .fan_speed = (hvac_fan_t)persisted->fan_speed,
+        .eco_mode = hvac_state_has(persisted, HVAC_STATE_ECO),
+        .night_mode = hvac_state_has(persisted, HVAC_STATE_NIGHT),
+        .display_on = hvac_state_has(persisted, HVAC_STATE_DISPLAY),
+        .swing_on = hvac_state_has(persisted, HVAC_STATE_SWING),
+        .purifier_on = hvac_state_has(persisted, HVAC_STATE_PURIFIER),
+        .mute_on = hvac_state_has(persisted, HVAC_STATE_MUTE),
+    };
+    
+    hvac_state_lock();
+    boot_sync_pending = true;
+    xSemaphoreGive(state_mutex);
+    
+    err = hvac_apply(&delta);
+    
+    hvac_state_lock();
+    if (err != ESP_OK) {
+        boot_sync_pending = false;
+        ESP_LOGW(TAG, "[HVAC] Could not re-apply persisted settings: %s", esp_err_to_name(err));
+    } else if (boot_sync_pending && shadow_tracker.pending == 0) {
+        hvac_boot_synced("AC already matched, nothing sent");
+    }
+    xSemaphoreGive(state_mutex);
+}
+
 /**
  * @brief Initialize HVAC driver
  */
@@ -818,14 +1530,22 @@ esp_err_t hvac_driver_init(void)
     
     ESP_LOGI(TAG, "[HVAC] Installing UART driver");
     ret = uart_driver_install(HVAC_UART_NUM, HVAC_UART_BUF_SIZE * 2, 
-                             HVAC_UART_BUF_SIZE * 2, 0, NULL, 0);
+                             HVAC_UART_BUF_SIZE * 2, HVAC_UART_EVENT_QUEUE_LEN,
+                             &uart_event_queue, 0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "[ERROR] Failed to install UART driver: %s", esp_err_to_name(ret));
         return ret;
     }
     ESP_LOGI(TAG, "[OK] UART driver installed");
     
+    // Raise UART_DATA after a short idle gap so frames are handed over immediately
+    ret = uart_set_rx_timeout(HVAC_UART_NUM, HVAC_UART_RX_TOUT_SYMBOLS);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "[WARN] Failed to set UART RX timeout: %s", esp_err_to_name(ret));
+    }
+    
     // Create RX task
+    hvac_frame_parser_init(&rx_parser, hvac_rx_frame_handler, NULL);
     ESP_LOGI(TAG, "[HVAC] Creating RX task");
     BaseType_t task_ret = xTaskCreate(hvac_rx_task, "hvac_rx", 3072, NULL, 5, NULL);
     if (task_ret != pdPASS) {
@@ -834,15 +1554,52 @@ esp_err_t hvac_driver_init(void)
     }
     ESP_LOGI(TAG, "[OK] RX task created");
     
+    // Create TX queue and task
+    ESP_LOGI(TAG, "[HVAC] Creating TX task");
+    tx_queue = xQueueCreate(HVAC_TX_QUEUE_LEN, sizeof(hvac_tx_item_t));
+    if (tx_queue == NULL) {
+        ESP_LOGE(TAG, "[ERROR] Failed to create TX queue");
+        return ESP_FAIL;
+    }
+    task_ret = xTaskCreate(hvac_tx_task, "hvac_tx", 3072, NULL, 5, NULL);
+    if (task_ret != pdPASS) {
+        ESP_LOGE(TAG, "[ERROR] Failed to create TX task");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "[OK] TX task created");
+    
+    // Create command queue and task
+    ESP_LOGI(TAG, "[HVAC] Creating command task");
+    cmd_queue = xQueueCreate(HVAC_CMD_QUEUE_LEN, sizeof(hvac_state_delta_t));
+    if (cmd_queue == NULL) {
+        ESP_LOGE(TAG, "[ERROR] Failed to create command queue");
+        return ESP_FAIL;
+    }
+    task_ret = xTaskCreate(hvac_cmd_task, "hvac_cmd", 3072, NULL, 5, &cmd_task_handle);
+    if (task_ret != pdPASS) {
+        ESP_LOGE(TAG, "[ERROR] Failed to create command task");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "[OK] Command task created");
+    
     // Load saved settings from NVS
     ESP_LOGI(TAG, "[HVAC] Loading saved settings from NVS");
     hvac_load_settings();
+    hvac_journal_init();
+    hvac_journal_record(&current_state);  // Seeds a freshly formatted journal
+    hvac_state_lock();
+    hvac_state_t persisted = current_state;
+    hvac_state_publish();
+    xSemaphoreGive(state_mutex);
     
     // Flush any pending NVS saves from previous session (shouldn't be any, but safety)
     nvs_save_pending = false;
     
     ESP_LOGI(TAG, "[OK] HVAC driver initialized successfully");
     
+#if HVAC_BOOT_RECONCILE
+    hvac_boot_reconcile(&persisted);
+#else
     // Send initial keepalive
     ESP_LOGI(TAG, "[HVAC] Sending initial keepalive");
     vTaskDelay(pdMS_TO_TICKS(100));
@@ -851,7 +1608,8 @@ esp_err_t hvac_driver_init(void)
     
     // Apply loaded settings to HVAC
     ESP_LOGI(TAG, "[HVAC] Applying loaded settings to HVAC");
-    hvac_build_and_send_command();
+    hvac_build_and_send_command(&persisted);
+#endif
     
     return ESP_OK;
 }
@@ -865,9 +1623,167 @@ esp_err_t hvac_get_state(hvac_state_t *state)
         return ESP_ERR_INVALID_ARG;
     }
 
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    memcpy(state, &current_state, sizeof(hvac_state_t));
+    hvac_state_read(state);
+    return ESP_OK;
+}
+
+/**
+ * @brief Apply a change set under one lock and send one frame
+ */
+esp_err_t hvac_apply(const hvac_state_delta_t *delta)
+{
+    if (!delta) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (delta->fields == 0) {
+        return ESP_OK;
+    }
+
+    // The AC only takes whole degrees - round to nearest before the range check
+    int16_t target_temp_cd = (int16_t)(((int32_t)delta->target_temp_cd + 50) / 100 * 100);
+    if ((delta->fields & HVAC_FIELD_TEMP) &&
+        (target_temp_cd < HVAC_TEMP_MIN_CD || target_temp_cd > HVAC_TEMP_MAX_CD)) {
+        ESP_LOGW(TAG, "Temperature out of range: %d cd (valid: %d-%d)",
+                 delta->target_temp_cd, HVAC_TEMP_MIN_CD, HVAC_TEMP_MAX_CD);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    hvac_state_lock();
+
+    // Work on a copy so a rejected change set leaves the state untouched.
+    // Start from the published view so an unconfirmed earlier request is kept.
+    hvac_state_t next;
+    hvac_shadow_view(&next);
+    next.flags &= ~HVAC_STATE_PENDING;
+
+    if (delta->fields & HVAC_FIELD_MODE) {
+        next.mode = delta->mode;
+        if (delta->mode != HVAC_MODE_OFF) {
+            hvac_state_set(&next, HVAC_STATE_POWER, true);
+        }
+    }
+    if (delta->fields & HVAC_FIELD_POWER) {
+        hvac_state_set(&next, HVAC_STATE_POWER, delta->power_on);
+    }
+    if (delta->fields & HVAC_FIELD_TEMP) {
+        next.target_temp_cd = target_temp_cd;
+    }
+    if (delta->fields & HVAC_FIELD_ECO) {
+        hvac_state_set(&next, HVAC_STATE_ECO, delta->eco_mode);
+    }
+    if (delta->fields & HVAC_FIELD_FAN) {
+        next.fan_speed = delta->fan_speed;
+    }
+    if (delta->fields & HVAC_FIELD_NIGHT) {
+        hvac_state_set(&next, HVAC_STATE_NIGHT, delta->night_mode);
+    }
+    if (delta->fields & HVAC_FIELD_DISPLAY) {
+        hvac_state_set(&next, HVAC_STATE_DISPLAY, delta->display_on);
+    }
+    if (delta->fields & HVAC_FIELD_SWING) {
+        hvac_state_set(&next, HVAC_STATE_SWING, delta->swing_on);
+    }
+    if (delta->fields & HVAC_FIELD_PURIFIER) {
+        hvac_state_set(&next, HVAC_STATE_PURIFIER, delta->purifier_on);
+    }
+    if (delta->fields & HVAC_FIELD_MUTE) {
+        hvac_state_set(&next, HVAC_STATE_MUTE, delta->mute_on);
+    }
+
+    // Eco mode only works in COOL mode (checked against the resulting mode)
+    if ((delta->fields & HVAC_FIELD_ECO) && hvac_state_has(&next, HVAC_STATE_ECO) && next.mode != HVAC_MODE_COOL) {
+        xSemaphoreGive(state_mutex);
+        ESP_LOGW(TAG, "Eco mode only available in COOL mode");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // In eco mode, fan is forced to AUTO
+    if ((delta->fields & HVAC_FIELD_FAN) && hvac_state_has(&next, HVAC_STATE_ECO) && next.fan_speed != HVAC_FAN_AUTO) {
+        ESP_LOGW(TAG, "Fan speed ignored in eco mode (forced to AUTO)");
+        next.fan_speed = HVAC_FAN_AUTO;
+    }
+
+    // Skip the frame when it would only restate what the AC last confirmed
+    // (repeated automations, coordinators re-asserting state): no UART
+    // traffic and no beep from the indoor unit. Only when nothing else is
+    // on its way to the AC, since a frame in flight may change that state.
+    // Encoded before mute is copied so a mute-only change is still sent.
+    uint8_t frame[HVAC_CONTROL_FRAME_LEN];
+    uint8_t confirmed_frame[HVAC_CONTROL_FRAME_LEN];
+    hvac_encode_command(&next, frame);
+    hvac_encode_command(&current_state, confirmed_frame);
+    bool suppress = status_confirmed && shadow_tracker.pending == 0 && !hvac_tx_control_in_flight() &&
+                    memcmp(frame, confirmed_frame, sizeof(frame)) == 0;
+
+    // The AC does not report mute back: the request is the state
+    hvac_state_set(&current_state, HVAC_STATE_MUTE, hvac_state_has(&next, HVAC_STATE_MUTE));
+
+    desired_state = next;
+    bool pending = hvac_shadow_track_request(&shadow_tracker,
+                                             hvac_state_diff(&current_state, &next) & HVAC_SHADOW_FIELDS,
+                                             esp_timer_get_time());
+    hvac_state_publish();
+
+    // Let the Zigbee layer show the request and its pending indicator right away
+    hvac_state_t view;
+    hvac_shadow_view(&view);
+    uint32_t changed = hvac_state_diff(&notified_state, &view);
+    notified_state = view;
     xSemaphoreGive(state_mutex);
+
+    // The command task re-sends or rolls back; callers on other tasks never
+    // touch cmd_queue, so it has to be told a request is now pending
+    if (pending) {
+        hvac_cmd_task_wake();
+    }
+
+    ESP_LOGI(TAG, "Applying change set 0x%03lX: Power=%s, Mode=%d, Temp=%d°C, Fan=0x%02X, Eco=%s",
+             (unsigned long)delta->fields,
+             hvac_state_has(&next, HVAC_STATE_POWER) ? "ON" : "OFF",
+             next.mode,
+             next.target_temp_cd / 100,
+             next.fan_speed,
+             hvac_state_has(&next, HVAC_STATE_ECO) ? "ON" : "OFF");
+
+    hvac_save_settings();
+    esp_err_t err = ESP_OK;
+    if (suppress) {
+        tx_stats.suppressed++;
+        ESP_LOGI(TAG, "Change set matches confirmed AC state - frame suppressed");
+    } else {
+        err = hvac_send_frame(frame, sizeof(frame), HVAC_TX_CONTROL);
+    }
+    if (changed && state_change_callback) {
+        state_change_callback(changed);
+    }
+    return err;
+}
+
+/**
+ * @brief Queue a change set for the command task
+ */
+esp_err_t hvac_apply_async(const hvac_state_delta_t *delta)
+{
+    if (!delta) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cmd_queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Same rounding and range check as hvac_apply(), so the caller still gets the error
+    if (delta->fields & HVAC_FIELD_TEMP) {
+        int16_t target_temp_cd = (int16_t)(((int32_t)delta->target_temp_cd + 50) / 100 * 100);
+        if (target_temp_cd < HVAC_TEMP_MIN_CD || target_temp_cd > HVAC_TEMP_MAX_CD) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (xQueueSend(cmd_queue, delta, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Command queue full - change 0x%03lX dropped", (unsigned long)delta->fields);
+        return ESP_ERR_NO_MEM;
+    }
+    hvac_cmd_task_wake();
     return ESP_OK;
 }
 
@@ -876,12 +1792,8 @@ esp_err_t hvac_get_state(hvac_state_t *state)
  */
 esp_err_t hvac_set_power(bool power_on)
 {
-    ESP_LOGI(TAG, "Setting power: %s", power_on ? "ON" : "OFF");
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.power_on = power_on;
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_POWER, .power_on = power_on };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -889,15 +1801,8 @@ esp_err_t hvac_set_power(bool power_on)
  */
 esp_err_t hvac_set_mode(hvac_mode_t mode)
 {
-    ESP_LOGI(TAG, "Setting mode: %d", mode);
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.mode = mode;
-    if (mode != HVAC_MODE_OFF) {
-        current_state.power_on = true;
-    }
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_MODE, .mode = mode };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -905,17 +1810,8 @@ esp_err_t hvac_set_mode(hvac_mode_t mode)
  */
 esp_err_t hvac_set_temperature(uint8_t temp_c)
 {
-    if (temp_c < 16 || temp_c > 31) {
-        ESP_LOGW(TAG, "Temperature out of range: %d°C (valid: 16-31)", temp_c);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    ESP_LOGI(TAG, "Setting temperature: %d°C", temp_c);
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.target_temp_c = temp_c;
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_TEMP, .target_temp_cd = (int16_t)(temp_c * 100) };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -923,19 +1819,8 @@ esp_err_t hvac_set_temperature(uint8_t temp_c)
  */
 esp_err_t hvac_set_eco_mode(bool eco_on)
 {
-    ESP_LOGI(TAG, "Setting eco mode: %s", eco_on ? "ON" : "OFF");
-
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    // Eco mode only works in COOL mode
-    if (eco_on && current_state.mode != HVAC_MODE_COOL) {
-        xSemaphoreGive(state_mutex);
-        ESP_LOGW(TAG, "Eco mode only available in COOL mode");
-        return ESP_ERR_INVALID_STATE;
-    }
-    current_state.eco_mode = eco_on;
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_ECO, .eco_mode = eco_on };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -943,12 +1828,8 @@ esp_err_t hvac_set_eco_mode(bool eco_on)
  */
 esp_err_t hvac_set_display(bool display_on)
 {
-    ESP_LOGI(TAG, "Setting display: %s", display_on ? "ON" : "OFF");
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.display_on = display_on;
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_DISPLAY, .display_on = display_on };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -956,12 +1837,8 @@ esp_err_t hvac_set_display(bool display_on)
  */
 esp_err_t hvac_set_swing(bool swing_on)
 {
-    ESP_LOGI(TAG, "Setting swing: %s", swing_on ? "ON" : "OFF");
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.swing_on = swing_on;
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_SWING, .swing_on = swing_on };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -969,17 +1846,8 @@ esp_err_t hvac_set_swing(bool swing_on)
  */
 esp_err_t hvac_set_fan_speed(hvac_fan_t fan)
 {
-    ESP_LOGI(TAG, "Setting fan speed: %d", fan);
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.fan_speed = fan;
-    // In eco mode, fan is forced to AUTO
-    if (current_state.eco_mode) {
-        ESP_LOGW(TAG, "Fan speed ignored in eco mode (forced to AUTO)");
-        current_state.fan_speed = HVAC_FAN_AUTO;
-    }
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_FAN, .fan_speed = fan };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -988,7 +1856,7 @@ esp_err_t hvac_set_fan_speed(hvac_fan_t fan)
 esp_err_t hvac_request_status(void)
 {
     ESP_LOGI(TAG, "Requesting HVAC status");
-    return hvac_send_frame(get_status_frame, sizeof(get_status_frame));
+    return hvac_send_frame(get_status_frame, sizeof(get_status_frame), HVAC_TX_STATUS_REQUEST);
 }
 
 /**
@@ -997,7 +1865,77 @@ esp_err_t hvac_request_status(void)
 esp_err_t hvac_send_keepalive(void)
 {
     ESP_LOGD(TAG, "Sending keepalive");
-    return hvac_send_frame(keepalive_frame, sizeof(keepalive_frame));
+    return hvac_send_frame(keepalive_frame, sizeof(keepalive_frame), HVAC_TX_KEEPALIVE);
+}
+
+/**
+ * @brief Time since the last 34-byte status frame was decoded
+ */
+uint32_t hvac_get_status_age_ms(void)
+{
+    if (atomic_load(&status_generation) == 0) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)(esp_timer_get_time() / 1000) - atomic_load(&status_time_ms);
+}
+
+/**
+ * @brief Register/unregister the calling task as a status waiter
+ */
+static int hvac_status_waiter_add(TaskHandle_t task)
+{
+    int slot = -1;
+    portENTER_CRITICAL(&status_waiters_lock);
+    for (int i = 0; i < HVAC_REFRESH_MAX_WAITERS; i++) {
+        if (status_waiters[i] == NULL) {
+            status_waiters[i] = task;
+            slot = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&status_waiters_lock);
+    return slot;
+}
+
+static void hvac_status_waiter_remove(int slot)
+{
+    portENTER_CRITICAL(&status_waiters_lock);
+    status_waiters[slot] = NULL;
+    portEXIT_CRITICAL(&status_waiters_lock);
+}
+
+/**
+ * @brief Request status and wait until a fresh state has been applied
+ */
+esp_err_t hvac_refresh_state(uint32_t timeout_ms)
+{
+    // Sample the generation before the request goes out, so the frame that
+    // answers it cannot be missed
+    unsigned int generation = atomic_load(&status_generation);
+    ulTaskNotifyTake(pdTRUE, 0);  // Drop a notification left over from an earlier timeout
+    int slot = hvac_status_waiter_add(xTaskGetCurrentTaskHandle());
+    if (slot < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = hvac_request_status();
+    if (err != ESP_OK) {
+        hvac_status_waiter_remove(slot);
+        return err;
+    }
+
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+    while (atomic_load(&status_generation) == generation) {
+        TickType_t remaining = deadline - xTaskGetTickCount();
+        if ((int32_t)remaining <= 0) {
+            err = ESP_ERR_TIMEOUT;
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, remaining);
+    }
+
+    hvac_status_waiter_remove(slot);
+    return err;
 }
 
 /**
@@ -1005,12 +1943,8 @@ esp_err_t hvac_send_keepalive(void)
  */
 esp_err_t hvac_set_night_mode(bool night_on)
 {
-    ESP_LOGI(TAG, "Setting night mode: %s", night_on ? "ON" : "OFF");
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.night_mode = night_on;
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_NIGHT, .night_mode = night_on };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -1018,12 +1952,8 @@ esp_err_t hvac_set_night_mode(bool night_on)
  */
 esp_err_t hvac_set_purifier(bool purifier_on)
 {
-    ESP_LOGI(TAG, "Setting purifier: %s", purifier_on ? "ON" : "OFF");
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.purifier_on = purifier_on;
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_PURIFIER, .purifier_on = purifier_on };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -1031,12 +1961,8 @@ esp_err_t hvac_set_purifier(bool purifier_on)
  */
 esp_err_t hvac_set_mute(bool mute_on)
 {
-    ESP_LOGI(TAG, "Setting mute: %s", mute_on ? "ON" : "OFF");
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    current_state.mute_on = mute_on;
-    xSemaphoreGive(state_mutex);
-    hvac_save_settings();
-    return hvac_build_and_send_command();
+    hvac_state_delta_t delta = { .fields = HVAC_FIELD_MUTE, .mute_on = mute_on };
+    return hvac_apply(&delta);
 }
 
 /**
@@ -1044,10 +1970,182 @@ esp_err_t hvac_set_mute(bool mute_on)
  */
 bool hvac_get_clean_status(void)
 {
-    xSemaphoreTake(state_mutex, portMAX_DELAY);
-    bool status = current_state.clean_status;
+    hvac_state_t state;
+    hvac_state_read(&state);
+    return hvac_state_has(&state, HVAC_STATE_CLEAN);
+}
+
+/**
+ * @brief Get RX path statistics
+ */
+esp_err_t hvac_get_rx_stats(hvac_rx_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *stats = rx_stats;
+    stats->crc_errors = rx_parser.stats.crc_errors;
+    stats->length_errors = rx_parser.stats.length_errors;
+    stats->bytes_discarded = rx_parser.stats.bytes_discarded;
+    stats->ring_high_water = rx_parser.stats.high_water;
+    stats->ring_overflows = rx_parser.stats.overflows;
+    return ESP_OK;
+}
+
+/**
+ * @brief Format the error/warning text for a state
+ */
+size_t hvac_format_error_text(const hvac_state_t *state, char *buf, size_t len)
+{
+    if (!state || !buf || len == 0) {
+        return 0;
+    }
+
+    int n;
+    if (state->fault_code != 0x00) {
+        // We only know that 0x04 = PC (Fashion Conflict), all other fault codes are unknown
+        if (state->fault_code == 0x04) {
+            n = snprintf(buf, len, "FAULT 0x%02X: PC - Fashion Conflict", state->fault_code);
+        } else {
+            n = snprintf(buf, len, "Error, check error code on the display");
+        }
+    } else if (state->warn_code != 0x00) {
+        n = snprintf(buf, len, "WARNING 0x%02X: %s", state->warn_code, hvac_error_code_text(state->warn_code));
+    } else {
+        buf[0] = '\0';
+        n = 0;
+    }
+
+    return (size_t)n < len ? (size_t)n : len - 1;
+}
+
+/**
+ * @brief Get TX path statistics
+ */
+esp_err_t hvac_get_tx_stats(hvac_tx_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *stats = tx_stats;
+    return ESP_OK;
+}
+
+/**
+ * @brief Get state lock statistics
+ */
+esp_err_t hvac_get_lock_stats(hvac_lock_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stats->snapshot_reads = atomic_load(&snapshot_reads);
+    stats->snapshot_retries = atomic_load(&snapshot_retries);
+    stats->writer_waits = atomic_load(&writer_waits);
+    return ESP_OK;
+}
+
+/**
+ * @brief Time from reset until the AC matched the persisted settings
+ */
+uint32_t hvac_get_boot_sync_ms(void)
+{
+    return boot_sync_ms;
+}
+
+/**
+ * @brief Get settings persistence statistics
+ */
+esp_err_t hvac_get_nvs_stats(hvac_nvs_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (journal_mounted) {
+        xSemaphoreTake(journal_mutex, portMAX_DELAY);
+        stats->journaled = true;
+        stats->commits = journal.stats.sets_committed;
+        stats->skipped = journal.stats.sets_unchanged;
+        stats->entries_written = journal.stats.records_written;
+        stats->page_erases = journal.stats.sector_erases;
+        xSemaphoreGive(journal_mutex);
+        return ESP_OK;
+    }
+
+    stats->journaled = false;
+    stats->commits = nvs_wear.commits;
+    stats->skipped = nvs_wear.skipped;
+    stats->entries_written = nvs_wear.entries_written;
+    stats->page_erases = nvs_wear.entries_written / NVS_ENTRIES_PER_PAGE;
+    return ESP_OK;
+}
+
+/**
+ * @brief Get the desired/reported shadow
+ */
+esp_err_t hvac_get_shadow(hvac_shadow_t *shadow)
+{
+    if (!shadow) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (state_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    hvac_state_lock();
+    shadow->reported = current_state;
+    shadow->desired = shadow_tracker.pending ? desired_state : current_state;
+    shadow->pending = shadow_tracker.pending;
+    shadow->attempts = shadow_tracker.attempts;
+    shadow->converged = shadow_tracker.converged;
+    shadow->resends = shadow_tracker.resends;
+    shadow->rollbacks = shadow_tracker.rollbacks;
+    xSemaphoreGive(state_mutex);
+    return ESP_OK;
+}
+
+/**
+ * @brief Configure the ambient temperature filter
+ */
+esp_err_t hvac_set_ambient_filter(const hvac_ambient_filter_t *filter)
+{
+    if (!filter || filter->deadband_cd > HVAC_AMBIENT_DEADBAND_CD_MAX ||
+        filter->ema_shift > HVAC_AMBIENT_EMA_SHIFT_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (state_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    hvac_state_lock();
+    ambient_filter = *filter;
+    xSemaphoreGive(state_mutex);
+    
+    ESP_LOGI(TAG, "Ambient filter: deadband=%u cd, EMA 1/%d",
+             filter->deadband_cd, 1 << filter->ema_shift);
+    return hvac_save_settings();
+}
+
+/**
+ * @brief Get the ambient temperature filter configuration
+ */
+esp_err_t hvac_get_ambient_filter(hvac_ambient_filter_t *filter)
+{
+    if (!filter) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (state_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    hvac_state_lock();
+    *filter = ambient_filter;
     xSemaphoreGive(state_mutex);
-    return status;
+    return ESP_OK;
 }
 
 /**
@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 #include "driver/uart.h"
 
@@ -49,23 +50,182 @@ typedef enum {
     HVAC_SWING_P5 = 0x06
 } hvac_swing_t;
 
-/* HVAC State structure */
+/* Setpoint range accepted by the AC, in 0.01°C (the ZCL temperature unit) */
+#define HVAC_TEMP_MIN_CD        1600
+#define HVAC_TEMP_MAX_CD        3100
+
+/* hvac_state_t flag bits */
+#define HVAC_STATE_POWER        (1u << 0)
+#define HVAC_STATE_ECO          (1u << 1)
+#define HVAC_STATE_NIGHT        (1u << 2)   // Night mode (sleep mode)
+#define HVAC_STATE_DISPLAY      (1u << 3)
+#define HVAC_STATE_SWING        (1u << 4)
+#define HVAC_STATE_PURIFIER     (1u << 5)   // Air purifier/ionizer
+#define HVAC_STATE_CLEAN        (1u << 6)   // Filter cleaning status (read-only from AC)
+#define HVAC_STATE_MUTE         (1u << 7)   // Mute (silent commands)
+#define HVAC_STATE_ERROR        (1u << 8)   // Fault reported by the AC
+#define HVAC_STATE_PENDING      (1u << 9)   // A requested change is not confirmed by the AC yet
+
+/* Dirty mask bits for hvac_state_change_callback_t.
+ * Flag changes use the HVAC_STATE_* bit of the flag itself. */
+#define HVAC_DIRTY_MODE         (1u << 16)
+#define HVAC_DIRTY_FAN          (1u << 17)
+#define HVAC_DIRTY_TARGET       (1u << 18)
+#define HVAC_DIRTY_AMBIENT      (1u << 19)
+#define HVAC_DIRTY_ERROR_CODE   (1u << 20)  // warn_code or fault_code
+
+/* Fields the AC reports back, so a request for them can be confirmed */
+#define HVAC_SHADOW_FIELDS      (HVAC_STATE_POWER | HVAC_STATE_ECO | HVAC_STATE_NIGHT | \
+                                 HVAC_STATE_DISPLAY | HVAC_STATE_SWING | HVAC_STATE_PURIFIER | \
+                                 HVAC_DIRTY_MODE | HVAC_DIRTY_FAN | HVAC_DIRTY_TARGET)
+#define HVAC_DIRTY_ALL          0xFFFFFFFFu
+
+/* HVAC State structure - packed into three words so copy and compare are cheap */
 typedef struct {
-    hvac_mode_t mode;
+    uint32_t flags;             // HVAC_STATE_* bits
+    uint8_t mode;               // hvac_mode_t
+    uint8_t fan_speed;          // hvac_fan_t
+    uint8_t warn_code;          // Raw warning code from the 28-byte frame (0 = none)
+    uint8_t fault_code;         // Raw fault code from the 28-byte frame (0 = none)
+    int16_t target_temp_cd;     // Setpoint in 0.01°C, whole degrees 16-31°C
+    int16_t ambient_temp_cd;    // Current room temperature in 0.01°C
+} hvac_state_t;
+
+_Static_assert(sizeof(hvac_state_t) == 12, "hvac_state_t should stay three words");
+
+/**
+ * @brief Test a flag of a state
+ */
+static inline bool hvac_state_has(const hvac_state_t *state, uint32_t flag)
+{
+    return (state->flags & flag) != 0;
+}
+
+/**
+ * @brief Compute the HVAC_DIRTY_* mask of fields that differ between two states
+ */
+static inline uint32_t hvac_state_diff(const hvac_state_t *a, const hvac_state_t *b)
+{
+    uint32_t dirty = a->flags ^ b->flags;
+
+    if (a->mode != b->mode) dirty |= HVAC_DIRTY_MODE;
+    if (a->fan_speed != b->fan_speed) dirty |= HVAC_DIRTY_FAN;
+    if (a->target_temp_cd != b->target_temp_cd) dirty |= HVAC_DIRTY_TARGET;
+    if (a->ambient_temp_cd != b->ambient_temp_cd) dirty |= HVAC_DIRTY_AMBIENT;
+    if (a->warn_code != b->warn_code || a->fault_code != b->fault_code) dirty |= HVAC_DIRTY_ERROR_CODE;
+    return dirty;
+}
+
+/**
+ * @brief Set or clear a flag of a state
+ */
+static inline void hvac_state_set(hvac_state_t *state, uint32_t flag, bool on)
+{
+    state->flags = on ? (state->flags | flag) : (state->flags & ~flag);
+}
+
+/* TX path statistics */
+typedef struct {
+    uint32_t frames_sent;       // Frames written to the UART (shadow re-sends included)
+    uint32_t control_frames;    // Control frames taken from the queue
+    uint32_t acked;             // Control frames answered by a status frame that started after the write
+    uint32_t ack_timeouts;      // Control frames with no such status frame within HVAC_SHADOW_RESEND_MS
+    uint32_t superseded;        // Control frames dropped because a newer one was queued
+    uint32_t queue_full;        // Frames rejected because the TX queue was full
+    uint32_t suppressed;        // Control frames skipped because they matched the confirmed AC state
+    uint32_t last_rtt_us;       // Control frame written -> acknowledging status frame decoded
+    uint32_t max_rtt_us;
+    uint64_t total_rtt_us;      // Divide by acked for the average
+} hvac_tx_stats_t;
+
+/* State access statistics */
+typedef struct {
+    uint32_t snapshot_reads;    // hvac_get_state()/hvac_get_clean_status() calls (never block)
+    uint32_t snapshot_retries;  // Reads repeated because a writer published two snapshots meanwhile
+    uint32_t writer_waits;      // Writers that found state_mutex held by another writer
+} hvac_lock_stats_t;
+
+/* Settings persistence statistics. Without the journal partition they
+ * describe the NVS blob and are kept in NVS across reboots; with it they
+ * describe the journal and count from boot (journaled = true). */
+typedef struct {
+    bool journaled;             // Settings go to the journal partition, not NVS
+    uint32_t commits;           // Settings blobs committed (journal: change sets committed)
+    uint32_t skipped;           // Saves dropped because flash already held the same settings
+    uint32_t entries_written;   // NVS entries consumed by those commits (journal: records appended)
+    uint32_t page_erases;       // Estimated NVS page erases (journal: sectors erased)
+} hvac_nvs_stats_t;
+
+/* Desired vs reported shadow */
+typedef struct {
+    hvac_state_t reported;      // Last state decoded from the AC
+    hvac_state_t desired;       // Last state requested through hvac_apply()
+    uint32_t pending;           // HVAC_SHADOW_FIELDS bits where the AC has not converged yet
+    uint8_t attempts;           // Control frames sent for the pending request
+    uint32_t converged;         // Requests confirmed by the AC
+    uint32_t resends;           // Control frames re-sent because the AC had not converged
+    uint32_t rollbacks;         // Requests abandoned and rolled back to the reported state
+} hvac_shadow_t;
+
+/* Tasks that may block in hvac_refresh_state() at the same time */
+#define HVAC_REFRESH_MAX_WAITERS            4
+
+/* Ambient temperature filter defaults */
+#define HVAC_AMBIENT_DEADBAND_CD_DEFAULT    20  // 0.2°C: ignore sensor jitter below this
+#define HVAC_AMBIENT_DEADBAND_CD_MAX        200 // 2°C: anything wider hides real room changes
+#define HVAC_AMBIENT_EMA_SHIFT_DEFAULT      2   // New sample weight 1/4
+#define HVAC_AMBIENT_EMA_SHIFT_MAX          6
+
+/* Ambient temperature filter applied before the state is published */
+typedef struct {
+    uint16_t deadband_cd;   // Minimum change of the filtered value before it is published (0 = off)
+    uint8_t ema_shift;      // EMA weight 1/2^n for each new sample (0 = off)
+} hvac_ambient_filter_t;
+
+/* Field selectors for hvac_state_delta_t */
+typedef enum {
+    HVAC_FIELD_POWER    = (1 << 0),
+    HVAC_FIELD_MODE     = (1 << 1),
+    HVAC_FIELD_TEMP     = (1 << 2),
+    HVAC_FIELD_FAN      = (1 << 3),
+    HVAC_FIELD_ECO      = (1 << 4),
+    HVAC_FIELD_NIGHT    = (1 << 5),
+    HVAC_FIELD_DISPLAY  = (1 << 6),
+    HVAC_FIELD_SWING    = (1 << 7),
+    HVAC_FIELD_PURIFIER = (1 << 8),
+    HVAC_FIELD_MUTE     = (1 << 9),
+} hvac_field_t;
+
+/* Change set for hvac_apply() - only fields selected in 'fields' are used */
+typedef struct {
+    uint32_t fields;        // Bitmask of hvac_field_t
     bool power_on;
-    uint8_t target_temp_c;  // Temperature in Celsius (16-31)
-    float ambient_temp_c;   // Current room temperature (with decimal precision)
+    hvac_mode_t mode;
+    int16_t target_temp_cd; // 0.01°C (ZCL units), rounded to whole degrees, 16-31°C
+    hvac_fan_t fan_speed;
     bool eco_mode;
-    bool night_mode;        // Night mode (sleep mode)
+    bool night_mode;
     bool display_on;
     bool swing_on;
-    bool purifier_on;       // Air purifier/ionizer
-    bool clean_status;      // Filter cleaning status (read-only from AC)
-    bool mute_on;           // Mute (silent commands)
-    hvac_fan_t fan_speed;
-    bool error;
-    char error_text[64];
-} hvac_state_t;
+    bool purifier_on;
+    bool mute_on;
+} hvac_state_delta_t;
+
+/* RX path statistics */
+typedef struct {
+    uint32_t frames_decoded;    // Frames with valid CRC handed to the decoder
+    uint32_t crc_errors;        // Complete frames rejected by the parser on CRC
+    uint32_t length_errors;     // Headers announcing an unsupported frame length
+    uint32_t bytes_discarded;   // Noise bytes dropped while hunting for a header
+    uint32_t ring_high_water;   // Peak RX ring occupancy in bytes (sizing aid for HVAC_RX_RING_SIZE)
+    uint32_t ring_overflows;    // RX ring full - pending bytes dropped
+    uint32_t uart_overflows;    // UART FIFO overflow / driver buffer full events
+    uint32_t callbacks;         // State change notifications delivered
+    uint32_t last_latency_us;   // End of frame on the wire -> state change callback
+    uint32_t max_latency_us;
+    uint64_t total_latency_us;  // Divide by callbacks for the average
+    uint64_t saved_us_total;    // Cumulative latency saved vs the old 10 ms polling RX loop
+} hvac_rx_stats_t;
 
 /* UART Configuration */
 #define HVAC_UART_NUM           UART_NUM_1
@@ -88,11 +248,51 @@ esp_err_t hvac_driver_init(void);
 /**
  * @brief Get current HVAC state
  * 
+ * Lock-free: copies the latest published snapshot and never blocks behind
+ * the RX task. This is the state reported by the AC, with any field of a
+ * request the AC has not confirmed yet taken from the request, and
+ * HVAC_STATE_PENDING set while that is the case.
+ * 
  * @param state Pointer to state structure to fill
  * @return ESP_OK on success
  */
 esp_err_t hvac_get_state(hvac_state_t *state);
 
+/**
+ * @brief Apply several settings at once and send a single command frame
+ * 
+ * The change set is validated against the resulting state as a whole and
+ * either applied completely or not at all:
+ * - target temperature is rounded to whole degrees and must be 16-31°C
+ * - eco mode can only be on in COOL mode
+ * - a fan speed set while eco is on is forced to AUTO
+ * - a mode other than OFF turns power on unless power is also in the set
+ * 
+ * No frame is sent when the resulting command frame equals the one for the
+ * state the AC last confirmed (counted in hvac_tx_stats_t.suppressed).
+ * 
+ * @param delta Fields to change
+ * @return ESP_OK on success (also for an empty set, which sends nothing)
+ *         ESP_ERR_INVALID_ARG if delta is NULL or a value is out of range
+ *         ESP_ERR_INVALID_STATE if the resulting combination is not allowed
+ */
+esp_err_t hvac_apply(const hvac_state_delta_t *delta);
+
+/**
+ * @brief Queue a change set for hvac_apply() on the driver's command task
+ * 
+ * Never blocks, so it is safe from the Zigbee stack task. Only the
+ * temperature range is checked up front. Errors that depend on the current
+ * state are logged by the command task.
+ * 
+ * @param delta Fields to change (copied)
+ * @return ESP_OK if queued
+ *         ESP_ERR_INVALID_ARG if delta is NULL or the temperature is out of range
+ *         ESP_ERR_INVALID_STATE if the driver is not initialized
+ *         ESP_ERR_NO_MEM if the command queue is full
+ */
+esp_err_t hvac_apply_async(const hvac_state_delta_t *delta);
+
 /**
  * @brief Set HVAC power state
  * 
@@ -194,13 +394,132 @@ esp_err_t hvac_request_status(void);
  */
 esp_err_t hvac_send_keepalive(void);
 
+/**
+ * @brief Time since the last 34-byte status frame was decoded
+ * 
+ * @return Age in milliseconds, UINT32_MAX if no status frame has been received yet
+ */
+uint32_t hvac_get_status_age_ms(void);
+
+/**
+ * @brief Request status and wait until a fresh state has been applied
+ * 
+ * Unlike hvac_request_status(), returns only once a 34-byte status frame
+ * decoded after the call has been applied to the published state (or the
+ * timeout expires). Blocks the calling task on a task notification; up to
+ * HVAC_REFRESH_MAX_WAITERS tasks may wait at the same time and are all woken
+ * by the same frame. Must not be called from the RX task.
+ * 
+ * @param timeout_ms Maximum time to wait
+ * @return ESP_OK once a new status frame has been applied,
+ *         ESP_ERR_TIMEOUT if none arrived in time,
+ *         ESP_ERR_NO_MEM if too many tasks are already waiting,
+ *         or the error from sending the status request
+ */
+esp_err_t hvac_refresh_state(uint32_t timeout_ms);
+
+/**
+ * @brief Get RX path statistics (frame count and wire-to-callback latency)
+ * 
+ * @param stats Pointer to statistics structure to fill
+ * @return ESP_OK on success
+ */
+esp_err_t hvac_get_rx_stats(hvac_rx_stats_t *stats);
+
+/**
+ * @brief Format the error/warning text for a state
+ * 
+ * Resolved on demand from the raw warn/fault codes; nothing is stored in
+ * the state itself.
+ * 
+ * @param state State to describe
+ * @param buf Destination buffer
+ * @param len Size of buf
+ * @return Length of the text (0 when there is no error or warning)
+ */
+size_t hvac_format_error_text(const hvac_state_t *state, char *buf, size_t len);
+
+/**
+ * @brief Get TX path statistics (pacing and acknowledgement round trip; re-sends are in hvac_shadow_t)
+ * 
+ * @param stats Pointer to statistics structure to fill
+ * @return ESP_OK on success
+ */
+esp_err_t hvac_get_tx_stats(hvac_tx_stats_t *stats);
+
+/**
+ * @brief Get state access statistics (reader retries, writer contention)
+ * 
+ * @param stats Pointer to statistics structure to fill
+ * @return ESP_OK on success
+ */
+esp_err_t hvac_get_lock_stats(hvac_lock_stats_t *stats);
+
+/**
+ * @brief Time from reset until the AC matched the persisted settings
+ * 
+ * Set once at boot, either when the first status frame already matched or
+ * when the AC confirmed (or rejected) the re-applied settings.
+ * 
+ * @return Milliseconds since reset, 0 if not synchronized (yet)
+ */
+uint32_t hvac_get_boot_sync_ms(void);
+
+/**
+ * @brief Get settings persistence statistics (commits, skipped writes, flash wear)
+ * 
+ * Reports the settings journal when it is mounted (counts since boot),
+ * otherwise the NVS blob (lifetime counts). NVS skipped saves are persisted
+ * with the next real commit, so a few may be lost across a reboot.
+ * 
+ * @param stats Pointer to statistics structure to fill
+ * @return ESP_OK on success
+ */
+esp_err_t hvac_get_nvs_stats(hvac_nvs_stats_t *stats);
+
+/**
+ * @brief Get the desired/reported shadow
+ * 
+ * A request is re-sent until the AC reports the requested values. If it has
+ * not converged after a few attempts it is dropped, the published state falls
+ * back to the reported one and the state change callback fires for the
+ * fields that were rolled back.
+ * 
+ * @param shadow Pointer to shadow structure to fill
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE before hvac_driver_init()
+ */
+esp_err_t hvac_get_shadow(hvac_shadow_t *shadow);
+
+/**
+ * @brief Configure the ambient temperature filter
+ * 
+ * Raw readings go through an integer EMA, and the published ambient temperature
+ * only moves once the filtered value differs from it by at least the deadband.
+ * The configuration is persisted to NVS.
+ * 
+ * @param filter New filter configuration
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if deadband_cd is above
+ *         HVAC_AMBIENT_DEADBAND_CD_MAX or ema_shift above HVAC_AMBIENT_EMA_SHIFT_MAX
+ */
+esp_err_t hvac_set_ambient_filter(const hvac_ambient_filter_t *filter);
+
+/**
+ * @brief Get the ambient temperature filter configuration
+ * 
+ * @param filter Pointer to configuration structure to fill
+ * @return ESP_OK on success
+ */
+esp_err_t hvac_get_ambient_filter(hvac_ambient_filter_t *filter);
+
 /**
  * @brief State change callback function type
  * 
  * Called when UART receives a state change from the AC unit.
  * This allows immediate notification instead of waiting for polling.
+ * 
+ * @param changed HVAC_DIRTY_* / HVAC_STATE_* mask of the fields that changed
  */
-typedef void (*hvac_state_change_callback_t)(void);
+typedef void (*hvac_state_change_callback_t)(uint32_t changed);
 
 /**
  * @brief Register callback for state changes
@@ -0,0 +1,70 @@
+/*
+ * HVAC Warning/Fault Code Table Implementation
+ */
+
+#include "hvac_error_codes.h"
+
+/* Letter and digit the display shows for a code byte (0 if the nibble has no letter) */
+#define HVAC_ERR_LETTER(c)  ((((c) >> 4) >= 0x0C) ? 'C' + (((c) >> 4) - 0x0C) : \
+                             (((c) >> 4) >= 0x08) ? 'H' + (((c) >> 4) - 0x08) : \
+                             (((c) >> 4) >= 0x04) ? 'L' + (((c) >> 4) - 0x04) : \
+                                                    'P' + ((c) >> 4))
+#define HVAC_ERR_DIGIT(c)   ((((c) & 0x0F) <= 9) ? '0' + ((c) & 0x0F) : 'A' + (((c) & 0x0F) - 10))
+
+/* One ternary per table entry; codes are matched in table order like the old linear scan */
+#define HVAC_ERR_MATCH(c, id, letter, digit, desc) \
+    (HVAC_ERR_LETTER(c) == (letter) && HVAC_ERR_DIGIT(c) == (digit)) ? HVAC_ERR_##id :
+#define HVAC_ERR_LOOKUP(c) \
+    ((c) == 0x80 ? HVAC_ERR_CL : HVAC_ERROR_CODE_TABLE(HVAC_ERR_MATCH, c) HVAC_ERR_UNKNOWN)
+
+#define HVAC_ERR_ROW(r) \
+    HVAC_ERR_LOOKUP((r) + 0x0), HVAC_ERR_LOOKUP((r) + 0x1), HVAC_ERR_LOOKUP((r) + 0x2), HVAC_ERR_LOOKUP((r) + 0x3), \
+    HVAC_ERR_LOOKUP((r) + 0x4), HVAC_ERR_LOOKUP((r) + 0x5), HVAC_ERR_LOOKUP((r) + 0x6), HVAC_ERR_LOOKUP((r) + 0x7), \
+    HVAC_ERR_LOOKUP((r) + 0x8), HVAC_ERR_LOOKUP((r) + 0x9), HVAC_ERR_LOOKUP((r) + 0xA), HVAC_ERR_LOOKUP((r) + 0xB), \
+    HVAC_ERR_LOOKUP((r) + 0xC), HVAC_ERR_LOOKUP((r) + 0xD), HVAC_ERR_LOOKUP((r) + 0xE), HVAC_ERR_LOOKUP((r) + 0xF)
+
+_Static_assert(HVAC_ERR_COUNT <= UINT8_MAX, "error code ids must fit the uint8_t index");
+
+/* Code byte -> table id, fully resolved by the compiler */
+static const uint8_t error_code_index[256] = {
+    HVAC_ERR_ROW(0x00), HVAC_ERR_ROW(0x10), HVAC_ERR_ROW(0x20), HVAC_ERR_ROW(0x30),
+    HVAC_ERR_ROW(0x40), HVAC_ERR_ROW(0x50), HVAC_ERR_ROW(0x60), HVAC_ERR_ROW(0x70),
+    HVAC_ERR_ROW(0x80), HVAC_ERR_ROW(0x90), HVAC_ERR_ROW(0xA0), HVAC_ERR_ROW(0xB0),
+    HVAC_ERR_ROW(0xC0), HVAC_ERR_ROW(0xD0), HVAC_ERR_ROW(0xE0), HVAC_ERR_ROW(0xF0),
+};
+
+#define HVAC_ERR_TEXT(arg, id, letter, digit, desc) [HVAC_ERR_##id] = desc,
+static const char *const error_code_text[HVAC_ERR_COUNT] = {
+    [HVAC_ERR_UNKNOWN] = "Unknown error code",
+    HVAC_ERROR_CODE_TABLE(HVAC_ERR_TEXT, 0)
+};
+
+#define HVAC_ERR_NAME(arg, id, letter, digit, desc) [HVAC_ERR_##id] = #id,
+static const char *const error_code_name[HVAC_ERR_COUNT] = {
+    [HVAC_ERR_UNKNOWN] = "??",
+    HVAC_ERROR_CODE_TABLE(HVAC_ERR_NAME, 0)
+};
+
+/**
+ * @brief Map a warning code byte to its table id
+ */
+hvac_error_code_id_t hvac_error_code_id(uint8_t code)
+{
+    return (hvac_error_code_id_t)error_code_index[code];
+}
+
+/**
+ * @brief Human-readable description of a warning code byte
+ */
+const char *hvac_error_code_text(uint8_t code)
+{
+    return error_code_text[error_code_index[code]];
+}
+
+/**
+ * @brief Two-character display code of a warning code byte
+ */
+const char *hvac_error_code_name(uint8_t code)
+{
+    return error_code_name[error_code_index[code]];
+}
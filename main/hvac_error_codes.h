@@ -0,0 +1,113 @@
+/*
+ * HVAC Warning/Fault Code Table Header
+ * 
+ * Maps the warning code byte of the ACW02 28-byte frame to the error codes
+ * from AIRTON-LIST-ERROR-CODE.EN.pdf. Plain C with no ESP-IDF dependencies.
+ * 
+ * Code byte encoding: high nibble selects the letter, low nibble the digit
+ *   0x0-0x3 -> P,Q,R,S   0x4-0x7 -> L,M,N,O   0x8-0xB -> H,I,J,K   0xC-0xF -> C,D,E,F
+ *   0x0-0x9 -> '0'-'9'   0xA-0xF -> 'A'-'F'
+ * 0x80 is the filter cleaning reminder (CL).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* X(id, letter, digit, description) */
+#define HVAC_ERROR_CODE_TABLE(X, arg) \
+    X(arg, CL, 'C', 'L', "Filter cleaning reminder (CL)") \
+    X(arg, D0, 'D', '0', "Compressor RMS phase current limit") \
+    X(arg, D1, 'D', '1', "Low RMS machine current limit") \
+    X(arg, D2, 'D', '2', "Lower gas discharge temperature limit") \
+    X(arg, D3, 'D', '3', "Extreme anti-freeze limit") \
+    X(arg, D4, 'D', '4', "Overload limit") \
+    X(arg, D5, 'D', '5', "IPM power module temperature limit") \
+    X(arg, E0, 'E', '0', "Protection against high discharge temperatures") \
+    X(arg, E1, 'E', '1', "Overload protection") \
+    X(arg, E2, 'E', '2', "Compressor overload protection") \
+    X(arg, E3, 'E', '3', "Frost protection") \
+    X(arg, E7, 'E', '7', "4-way valve malfunction") \
+    X(arg, E8, 'E', '8', "Abnormal outdoor ambient temperature") \
+    X(arg, H0, 'H', '0', "Compressor stalling or jamming") \
+    X(arg, H1, 'H', '1', "Startup failure") \
+    X(arg, H2, 'H', '2', "Compressor phase current peak protection") \
+    X(arg, H3, 'H', '3', "Compressor phase current RMS protection") \
+    X(arg, H4, 'H', '4', "IPM power module protection") \
+    X(arg, H5, 'H', '5', "IPM overheat protection") \
+    X(arg, H6, 'H', '6', "Compressor circuit phase detection error") \
+    X(arg, H7, 'H', '7', "Compressor phase loss error") \
+    X(arg, H8, 'H', '8', "Outdoor unit fan motor error") \
+    X(arg, H9, 'H', '9', "Outdoor unit fan motor phase current detection circuit error") \
+    X(arg, L0, 'L', '0', "Jumper error") \
+    X(arg, L1, 'L', '1', "Indoor fan motor zero crossing detection circuit malfunction") \
+    X(arg, L2, 'L', '2', "Indoor fan motor error") \
+    X(arg, L3, 'L', '3', "Communication fault between indoor and outdoor unit") \
+    X(arg, L4, 'L', '4', "Port selection error") \
+    X(arg, L5, 'L', '5', "EEPROM error on indoor unit") \
+    X(arg, L6, 'L', '6', "Communication fault between outdoor and indoor unit") \
+    X(arg, LL, 'L', 'L', "Function test") \
+    X(arg, P0, 'P', '0', "EEPROM error on outdoor unit") \
+    X(arg, P1, 'P', '1', "Power on error") \
+    X(arg, P2, 'P', '2', "AC current protection") \
+    X(arg, P3, 'P', '3', "High voltage protection") \
+    X(arg, P4, 'P', '4', "Low voltage protection") \
+    X(arg, P5, 'P', '5', "DC DC line voltage drop protection") \
+    X(arg, P6, 'P', '6', "Current detection circuit error") \
+    X(arg, P7, 'P', '7', "Overcurrent protection") \
+    X(arg, P8, 'P', '8', "PFC current detection circuit error") \
+    X(arg, P9, 'P', '9', "PFC protection") \
+    X(arg, PA, 'P', 'A', "IU and EU mismatch") \
+    X(arg, PC, 'P', 'C', "Fashion Conflict") \
+    X(arg, U0, 'U', '0', "Ambient temperature sensor (probe) open/closed circuit") \
+    X(arg, U1, 'U', '1', "Pipe temperature sensor (probe) open/closed circuit") \
+    X(arg, U2, 'U', '2', "Ambient temperature sensor (probe) open/closed circuit") \
+    X(arg, U3, 'U', '3', "UE Discharge Sensor (Probe) Open/Closed Circuit") \
+    X(arg, U4, 'U', '4', "UE pipe temperature sensor open/closed circuit (probe)") \
+    X(arg, U5, 'U', '5', "IPM power module temperature sensor open/closed circuit") \
+    X(arg, U6, 'U', '6', "Liquid pipe outlet temperature sensor open/closed circuit") \
+    X(arg, U7, 'U', '7', "Gas pipe outlet temperature sensor open/closed circuit") \
+    X(arg, U8, 'U', '8', "Discharge temperature sensor open/closed circuit")
+
+/* Stable code ids, one per table entry */
+#define HVAC_ERROR_CODE_ENUM(arg, id, letter, digit, desc) HVAC_ERR_##id,
+typedef enum {
+    HVAC_ERR_UNKNOWN = 0,
+    HVAC_ERROR_CODE_TABLE(HVAC_ERROR_CODE_ENUM, 0)
+    HVAC_ERR_COUNT
+} hvac_error_code_id_t;
+#undef HVAC_ERROR_CODE_ENUM
+
+/**
+ * @brief Map a warning code byte to its table id
+ * 
+ * Single lookup in a 256-entry index generated at compile time from the table.
+ * 
+ * @param code Raw code byte
+ * @return Table id, HVAC_ERR_UNKNOWN if the code is not in the table
+ */
+hvac_error_code_id_t hvac_error_code_id(uint8_t code);
+
+/**
+ * @brief Human-readable description of a warning code byte
+ * 
+ * @param code Raw code byte
+ * @return Description in static storage, never NULL ("Unknown error code" if not in the table)
+ */
+const char *hvac_error_code_text(uint8_t code);
+
+/**
+ * @brief Two-character display code of a warning code byte (e.g. "E1")
+ * 
+ * @param code Raw code byte
+ * @return Display code in static storage, "??" if not in the table
+ */
+const char *hvac_error_code_name(uint8_t code);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,200 @@
+/*
+ * HVAC Frame Parser Implementation
+ * 
+ * Streaming state machine: hunt header -> read type/length -> accumulate -> CRC
+ */
+
+#include "hvac_frame_parser.h"
+#include "hvac_crc.h"
+#include <string.h>
+
+/**
+ * @brief Check whether a length byte announces a supported frame size
+ */
+bool hvac_frame_len_valid(size_t len)
+{
+    return len == 13 || len == 18 || len == 28 || len == 34;
+}
+
+/**
+ * @brief Initialize a parser instance
+ */
+void hvac_frame_parser_init(hvac_frame_parser_t *parser, hvac_frame_handler_t handler, void *ctx)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->handler = handler;
+    parser->ctx = ctx;
+    parser->state = HVAC_PARSER_HUNT;
+}
+
+/**
+ * @brief Drop any partially received frame
+ */
+void hvac_frame_parser_reset(hvac_frame_parser_t *parser)
+{
+    parser->stats.bytes_discarded += parser->head - parser->tail;
+    parser->tail = parser->head;
+    parser->scan = parser->head;
+    parser->state = HVAC_PARSER_HUNT;
+    parser->expected_len = 0;
+}
+
+/**
+ * @brief Get the contiguous free region of the ring for a direct read
+ */
+size_t hvac_frame_parser_write_span(hvac_frame_parser_t *parser, uint8_t **dst)
+{
+    uint32_t used = parser->head - parser->tail;
+    if (used >= HVAC_RX_RING_SIZE) {
+        parser->stats.overflows++;
+        hvac_frame_parser_reset(parser);
+        used = 0;
+    }
+
+    uint32_t start = parser->head & HVAC_RX_RING_MASK;
+    size_t to_end = HVAC_RX_RING_SIZE - start;
+    size_t free_bytes = HVAC_RX_RING_SIZE - used;
+
+    *dst = &parser->ring[start];
+    return free_bytes < to_end ? free_bytes : to_end;
+}
+
+/**
+ * @brief Build a view of len bytes starting at ring position start
+ */
+static void hvac_frame_parser_view(const hvac_frame_parser_t *parser, uint32_t start, size_t len,
+                                   hvac_frame_view_t *view)
+{
+    uint32_t first = start & HVAC_RX_RING_MASK;
+    size_t to_end = HVAC_RX_RING_SIZE - first;
+
+    view->seg[0] = &parser->ring[first];
+    view->seg_len[0] = len < to_end ? len : to_end;
+    view->seg[1] = parser->ring;
+    view->seg_len[1] = len - view->seg_len[0];
+}
+
+/**
+ * @brief Verify the trailing CRC of a frame view
+ */
+static bool hvac_frame_view_crc_ok(const hvac_frame_view_t *view)
+{
+    size_t len = hvac_frame_view_len(view);
+    size_t body = len - 2;
+    size_t first = view->seg_len[0] < body ? view->seg_len[0] : body;
+
+    uint16_t crc = hvac_crc16_update(0xFFFF, view->seg[0], first);
+    crc = hvac_crc16_update(crc, view->seg[1], body - first);
+
+    uint16_t expected_crc = (hvac_frame_view_byte(view, len - 2) << 8) | hvac_frame_view_byte(view, len - 1);
+    return crc == expected_crc;
+}
+
+/**
+ * @brief Advance the state machine by the byte at the scan position
+ * 
+ * @return false if the candidate frame starting at tail must be rejected
+ */
+static bool hvac_frame_parser_step(hvac_frame_parser_t *parser)
+{
+    uint8_t byte = parser->ring[parser->scan & HVAC_RX_RING_MASK];
+    size_t offset = parser->scan - parser->tail;
+
+    parser->scan++;
+
+    switch (parser->state) {
+    case HVAC_PARSER_HUNT:
+        if (byte == HVAC_FRAME_HEADER_BYTE) {
+            parser->state = HVAC_PARSER_HEADER;
+        } else {
+            parser->stats.bytes_discarded++;
+            parser->tail = parser->scan;
+        }
+        return true;
+
+    case HVAC_PARSER_HEADER:
+        if (offset == 1 && byte != HVAC_FRAME_HEADER_BYTE) {
+            return false;
+        }
+        if (offset == HVAC_FRAME_LEN_OFFSET) {
+            if (!hvac_frame_len_valid(byte)) {
+                parser->stats.length_errors++;
+                return false;
+            }
+            parser->expected_len = byte;
+            parser->state = HVAC_PARSER_BODY;
+        }
+        return true;
+
+    case HVAC_PARSER_BODY: {
+        if (offset + 1 < parser->expected_len) {
+            return true;
+        }
+
+        // Frame complete - single CRC check, directly on the ring
+        hvac_frame_view_t view;
+        hvac_frame_parser_view(parser, parser->tail, parser->expected_len, &view);
+        if (!hvac_frame_view_crc_ok(&view)) {
+            parser->stats.crc_errors++;
+            return false;
+        }
+
+        parser->stats.frames_ok++;
+        if (parser->handler) {
+            parser->handler(&view, parser->ctx);
+        }
+        parser->tail = parser->scan;
+        parser->state = HVAC_PARSER_HUNT;
+        parser->expected_len = 0;
+        return true;
+    }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parse bytes previously written at the write span
+ * 
+ * Resync policy: when the candidate frame at tail is rejected, its first
+ * byte is discarded and scanning restarts right after it. The bytes are
+ * still in the ring, so re-examining them needs no copy.
+ */
+void hvac_frame_parser_commit(hvac_frame_parser_t *parser, size_t len)
+{
+    parser->head += len;
+
+    uint32_t used = parser->head - parser->tail;
+    if (used > parser->stats.high_water) {
+        parser->stats.high_water = used;
+    }
+
+    while (parser->scan != parser->head) {
+        if (hvac_frame_parser_step(parser)) {
+            continue;
+        }
+
+        parser->stats.bytes_discarded++;
+        parser->tail++;
+        parser->scan = parser->tail;
+        parser->state = HVAC_PARSER_HUNT;
+        parser->expected_len = 0;
+    }
+}
+
+/**
+ * @brief Copy received bytes into the ring and parse them
+ */
+void hvac_frame_parser_feed(hvac_frame_parser_t *parser, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        uint8_t *dst;
+        size_t span = hvac_frame_parser_write_span(parser, &dst);
+        size_t chunk = len < span ? len : span;
+
+        memcpy(dst, data, chunk);
+        hvac_frame_parser_commit(parser, chunk);
+        data += chunk;
+        len -= chunk;
+    }
+}
@@ -0,0 +1,166 @@
+/*
+ * HVAC Frame Parser Header
+ * 
+ * Incremental byte-at-a-time parser for ACW02 UART frames.
+ * Plain C with no ESP-IDF dependencies so it can be fed from a host test.
+ * 
+ * Received bytes are written straight into a power-of-two ring buffer owned
+ * by the parser. Complete frames are handed to the handler as a wrap-aware
+ * view into that ring, so nothing is copied between the UART read and the
+ * decoder.
+ * 
+ * Frame layout seen by the parser:
+ * [0-1]  Header: 0x7A 0x7A
+ * [2-3]  Type marker (e.g. 0xD5 0x21 status, 0xD1 0x21 ack)
+ * [4]    Total frame length in bytes (0x0D, 0x12, 0x1C, 0x22)
+ * [...]  Payload
+ * [n-2..n-1] CRC16, MSB first, over bytes [0..n-3]
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HVAC_FRAME_HEADER_BYTE      0x7A
+#define HVAC_FRAME_LEN_OFFSET       4
+#define HVAC_FRAME_MIN_LEN          13
+#define HVAC_FRAME_MAX_LEN          34
+
+/* RX ring size - must be a power of two */
+#ifndef HVAC_RX_RING_SIZE
+#define HVAC_RX_RING_SIZE           1024
+#endif
+#define HVAC_RX_RING_MASK           (HVAC_RX_RING_SIZE - 1)
+
+_Static_assert((HVAC_RX_RING_SIZE & HVAC_RX_RING_MASK) == 0, "HVAC_RX_RING_SIZE must be a power of two");
+_Static_assert(HVAC_RX_RING_SIZE > HVAC_FRAME_MAX_LEN, "HVAC_RX_RING_SIZE must hold a full frame");
+
+/* Parser state */
+typedef enum {
+    HVAC_PARSER_HUNT = 0,   // Waiting for first 0x7A
+    HVAC_PARSER_HEADER,     // Collecting second 0x7A, type and length bytes
+    HVAC_PARSER_BODY,       // Accumulating up to the announced length
+} hvac_parser_state_t;
+
+/* Parser statistics */
+typedef struct {
+    uint32_t frames_ok;         // Frames with valid CRC delivered to the handler
+    uint32_t crc_errors;        // Complete frames rejected on CRC
+    uint32_t length_errors;     // Headers announcing an unsupported length
+    uint32_t bytes_discarded;   // Bytes dropped while hunting/resyncing
+    uint32_t high_water;        // Maximum ring occupancy observed (bytes)
+    uint32_t overflows;         // Times the ring was full and pending bytes were dropped
+} hvac_frame_parser_stats_t;
+
+/* Wrap-aware view of a frame inside the ring (second segment empty unless it wraps) */
+typedef struct {
+    const uint8_t *seg[2];
+    size_t seg_len[2];
+} hvac_frame_view_t;
+
+/**
+ * @brief Frame length of a view
+ */
+static inline size_t hvac_frame_view_len(const hvac_frame_view_t *view)
+{
+    return view->seg_len[0] + view->seg_len[1];
+}
+
+/**
+ * @brief Byte at offset i of a view
+ */
+static inline uint8_t hvac_frame_view_byte(const hvac_frame_view_t *view, size_t i)
+{
+    return i < view->seg_len[0] ? view->seg[0][i] : view->seg[1][i - view->seg_len[0]];
+}
+
+/**
+ * @brief Frame handler called for every frame with a valid CRC
+ * 
+ * The view is only valid for the duration of the call.
+ * 
+ * @param frame View of the complete frame including header and CRC
+ * @param ctx User context passed to hvac_frame_parser_init()
+ */
+typedef void (*hvac_frame_handler_t)(const hvac_frame_view_t *frame, void *ctx);
+
+/* Parser instance */
+typedef struct {
+    uint8_t ring[HVAC_RX_RING_SIZE];
+    uint32_t head;              // Next write position (free-running)
+    uint32_t tail;              // First byte of the candidate frame (free-running)
+    uint32_t scan;              // Next byte to examine (free-running)
+    hvac_parser_state_t state;
+    size_t expected_len;
+    hvac_frame_handler_t handler;
+    void *ctx;
+    hvac_frame_parser_stats_t stats;
+} hvac_frame_parser_t;
+
+/**
+ * @brief Initialize a parser instance
+ * 
+ * @param parser Parser to initialize
+ * @param handler Called for each valid frame
+ * @param ctx User context forwarded to handler
+ */
+void hvac_frame_parser_init(hvac_frame_parser_t *parser, hvac_frame_handler_t handler, void *ctx);
+
+/**
+ * @brief Drop any partially received frame (e.g. after a UART error)
+ * 
+ * @param parser Parser instance
+ */
+void hvac_frame_parser_reset(hvac_frame_parser_t *parser);
+
+/**
+ * @brief Get the contiguous free region of the ring for a direct read
+ * 
+ * If the ring is full the pending bytes are dropped and counted as an
+ * overflow, so the returned span is never empty.
+ * 
+ * @param parser Parser instance
+ * @param dst Set to the write position
+ * @return Number of bytes that can be written at dst
+ */
+size_t hvac_frame_parser_write_span(hvac_frame_parser_t *parser, uint8_t **dst);
+
+/**
+ * @brief Parse bytes previously written at the span from hvac_frame_parser_write_span()
+ * 
+ * @param parser Parser instance
+ * @param len Number of bytes written
+ */
+void hvac_frame_parser_commit(hvac_frame_parser_t *parser, size_t len);
+
+/**
+ * @brief Copy received bytes into the ring and parse them
+ * 
+ * Each byte is examined once on the normal path. When a candidate frame is
+ * rejected (bad second header byte, unsupported length or CRC mismatch),
+ * its first byte is dropped and scanning restarts at the next byte, so a
+ * real header hidden inside the rejected bytes is not lost.
+ * 
+ * @param parser Parser instance
+ * @param data Received bytes
+ * @param len Number of bytes
+ */
+void hvac_frame_parser_feed(hvac_frame_parser_t *parser, const uint8_t *data, size_t len);
+
+/**
+ * @brief Check whether a length byte announces a supported frame size
+ * 
+ * @param len Length byte value
+ * @return true for 13, 18, 28 or 34
+ */
+bool hvac_frame_len_valid(size_t len);
+
+#ifdef __cplusplus
+}
+#endif
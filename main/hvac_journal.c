@@ -0,0 +1,335 @@
+/*
+ * HVAC Settings Journal Implementation
+ *
+ * Mount: scan every sector, keep the newest complete one, replay it.
+ * Set: append the changed keys and a COMMIT slot; rotate to a freshly
+ * erased sector when they do not fit.
+ */
+
+#include "hvac_journal.h"
+#include "hvac_crc.h"
+#include <string.h>
+
+#define SLOTS_PER_SECTOR    (HVAC_JOURNAL_SECTOR_SIZE / HVAC_JOURNAL_SLOT_SIZE)
+#define SCAN_CHUNK_SLOTS    32      // Slots read per flash access while scanning
+
+_Static_assert(HVAC_JOURNAL_MAX_KEYS <= 32, "valid mask is 32 bits");
+_Static_assert(HVAC_JOURNAL_MAX_KEYS + 2 < SLOTS_PER_SECTOR, "snapshot must fit in a sector");
+
+/* Result of scanning one sector */
+typedef struct {
+    bool complete;              // SECTOR and SNAPSHOT records found
+    uint32_t seq;
+    uint32_t end;               // Offset of the first erased slot
+    uint32_t values[HVAC_JOURNAL_MAX_KEYS];
+    uint32_t valid;
+    uint32_t replayed;
+    uint32_t torn;
+    // User records not committed yet; the last HVAC_JOURNAL_MAX_KEYS are kept,
+    // which covers any single change set or snapshot
+    uint8_t staged_key[HVAC_JOURNAL_MAX_KEYS];
+    uint32_t staged_value[HVAC_JOURNAL_MAX_KEYS];
+    uint32_t staged;
+} hvac_journal_scan_t;
+
+/**
+ * @brief CRC of a slot (everything but the CRC field itself)
+ */
+static uint16_t hvac_journal_slot_crc(const uint8_t *slot)
+{
+    uint16_t crc = hvac_crc16(slot, 2);
+    return hvac_crc16_update(crc, &slot[4], 4);
+}
+
+/**
+ * @brief Check whether a slot is still erased
+ */
+static bool hvac_journal_slot_erased(const uint8_t *slot)
+{
+    for (int i = 0; i < HVAC_JOURNAL_SLOT_SIZE; i++) {
+        if (slot[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Write one record at an absolute region offset
+ */
+static bool hvac_journal_write_slot(hvac_journal_t *journal, uint32_t offset, uint8_t key, uint32_t value)
+{
+    uint8_t slot[HVAC_JOURNAL_SLOT_SIZE];
+    slot[0] = key;
+    slot[1] = 0x00;
+    slot[4] = value & 0xFF;
+    slot[5] = (value >> 8) & 0xFF;
+    slot[6] = (value >> 16) & 0xFF;
+    slot[7] = (value >> 24) & 0xFF;
+    uint16_t crc = hvac_journal_slot_crc(slot);
+    slot[2] = crc & 0xFF;
+    slot[3] = crc >> 8;
+
+    if (journal->flash.write(journal->flash.ctx, offset, slot, sizeof(slot)) != 0) {
+        return false;
+    }
+    journal->stats.records_written++;
+    return true;
+}
+
+/**
+ * @brief Apply the last count staged records and start a new change set
+ *
+ * Staged records before those belong to a set whose COMMIT never landed.
+ */
+static void hvac_journal_scan_commit(hvac_journal_scan_t *scan, uint32_t count)
+{
+    uint32_t kept = scan->staged < HVAC_JOURNAL_MAX_KEYS ? scan->staged : HVAC_JOURNAL_MAX_KEYS;
+
+    if (count <= kept) {
+        for (uint32_t i = scan->staged - count; i < scan->staged; i++) {
+            uint8_t key = scan->staged_key[i % HVAC_JOURNAL_MAX_KEYS];
+            scan->values[key] = scan->staged_value[i % HVAC_JOURNAL_MAX_KEYS];
+            scan->valid |= 1u << key;
+            scan->replayed++;
+        }
+    }
+    scan->staged = 0;
+}
+
+/**
+ * @brief Read a sector and collect the values it holds
+ */
+static bool hvac_journal_scan_sector(const hvac_journal_t *journal, uint32_t sector, hvac_journal_scan_t *scan)
+{
+    uint8_t chunk[SCAN_CHUNK_SLOTS * HVAC_JOURNAL_SLOT_SIZE];
+    uint32_t base = sector * HVAC_JOURNAL_SECTOR_SIZE;
+    bool has_header = false;
+
+    memset(scan, 0, sizeof(*scan));
+    scan->end = HVAC_JOURNAL_SECTOR_SIZE;
+
+    for (uint32_t first = 0; first < SLOTS_PER_SECTOR; first += SCAN_CHUNK_SLOTS) {
+        if (journal->flash.read(journal->flash.ctx, base + first * HVAC_JOURNAL_SLOT_SIZE,
+                                chunk, sizeof(chunk)) != 0) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < SCAN_CHUNK_SLOTS; i++) {
+            const uint8_t *slot = &chunk[i * HVAC_JOURNAL_SLOT_SIZE];
+            uint32_t index = first + i;
+
+            if (hvac_journal_slot_erased(slot)) {
+                scan->end = index * HVAC_JOURNAL_SLOT_SIZE;
+                scan->complete = scan->complete && has_header;
+                return true;
+            }
+
+            uint16_t crc = slot[2] | (slot[3] << 8);
+            if (crc != hvac_journal_slot_crc(slot)) {
+                if (index == 0) {
+                    return true;    // Torn or foreign header: sector unusable
+                }
+                scan->torn++;
+                continue;
+            }
+
+            uint8_t key = slot[0];
+            uint32_t value = slot[4] | (slot[5] << 8) | (slot[6] << 16) | ((uint32_t)slot[7] << 24);
+
+            if (index == 0) {
+                if (key != HVAC_JOURNAL_KEY_SECTOR) {
+                    return true;
+                }
+                has_header = true;
+                scan->seq = value;
+            } else if (key == HVAC_JOURNAL_KEY_SNAPSHOT) {
+                scan->complete = (value == scan->seq);
+                hvac_journal_scan_commit(scan, scan->staged);
+            } else if (key == HVAC_JOURNAL_KEY_COMMIT) {
+                hvac_journal_scan_commit(scan, value);
+            } else if (key < HVAC_JOURNAL_MAX_KEYS) {
+                scan->staged_key[scan->staged % HVAC_JOURNAL_MAX_KEYS] = key;
+                scan->staged_value[scan->staged % HVAC_JOURNAL_MAX_KEYS] = value;
+                scan->staged++;
+            }
+        }
+    }
+
+    scan->complete = scan->complete && has_header;
+    return true;
+}
+
+/**
+ * @brief Erase a sector and start it with the current values
+ */
+static bool hvac_journal_start_sector(hvac_journal_t *journal, uint32_t sector, uint32_t seq)
+{
+    uint32_t base = sector * HVAC_JOURNAL_SECTOR_SIZE;
+    uint32_t offset = base;
+
+    if (journal->flash.erase_sector(journal->flash.ctx, base) != 0) {
+        return false;
+    }
+    journal->stats.sector_erases++;
+
+    if (!hvac_journal_write_slot(journal, offset, HVAC_JOURNAL_KEY_SECTOR, seq)) {
+        return false;
+    }
+    offset += HVAC_JOURNAL_SLOT_SIZE;
+
+    for (uint8_t key = 0; key < HVAC_JOURNAL_MAX_KEYS; key++) {
+        if (journal->valid & (1u << key)) {
+            if (!hvac_journal_write_slot(journal, offset, key, journal->values[key])) {
+                return false;
+            }
+            offset += HVAC_JOURNAL_SLOT_SIZE;
+        }
+    }
+
+    // Until this record lands the previous sector stays authoritative
+    if (!hvac_journal_write_slot(journal, offset, HVAC_JOURNAL_KEY_SNAPSHOT, seq)) {
+        return false;
+    }
+    offset += HVAC_JOURNAL_SLOT_SIZE;
+
+    journal->active_sector = sector;
+    journal->seq = seq;
+    journal->write_offset = offset - base;
+    return true;
+}
+
+/**
+ * @brief Mount a journal region and replay it
+ */
+bool hvac_journal_mount(hvac_journal_t *journal, const hvac_journal_flash_t *flash)
+{
+    memset(journal, 0, sizeof(*journal));
+    journal->flash = *flash;
+    journal->sector_count = flash->size / HVAC_JOURNAL_SECTOR_SIZE;
+    if (journal->sector_count < 2 || flash->size % HVAC_JOURNAL_SECTOR_SIZE != 0) {
+        return false;
+    }
+
+    hvac_journal_scan_t scan;
+    bool found = false;
+
+    for (uint32_t sector = 0; sector < journal->sector_count; sector++) {
+        if (!hvac_journal_scan_sector(journal, sector, &scan)) {
+            return false;
+        }
+        if (!scan.complete || (found && scan.seq <= journal->seq)) {
+            continue;
+        }
+        found = true;
+        journal->active_sector = sector;
+        journal->seq = scan.seq;
+        journal->write_offset = scan.end;
+        memcpy(journal->values, scan.values, sizeof(journal->values));
+        journal->valid = scan.valid;
+        journal->stats.records_replayed = scan.replayed;
+        journal->stats.torn_records = scan.torn;
+    }
+
+    if (!found) {
+        // Blank (or foreign) region: start an empty journal
+        return hvac_journal_start_sector(journal, 0, 1);
+    }
+    return true;
+}
+
+/**
+ * @brief Get the current value of a key
+ */
+bool hvac_journal_get(const hvac_journal_t *journal, uint8_t key, uint32_t *value)
+{
+    if (key >= HVAC_JOURNAL_MAX_KEYS || !(journal->valid & (1u << key))) {
+        return false;
+    }
+    *value = journal->values[key];
+    return true;
+}
+
+/**
+ * @brief Record a new value for a key
+ */
+bool hvac_journal_set(hvac_journal_t *journal, uint8_t key, uint32_t value)
+{
+    hvac_journal_entry_t entry = { .key = key, .value = value };
+    return hvac_journal_set_many(journal, &entry, 1);
+}
+
+/**
+ * @brief Record new values for several keys as one change set
+ */
+bool hvac_journal_set_many(hvac_journal_t *journal, const hvac_journal_entry_t *entries, size_t count)
+{
+    uint32_t seen = 0;
+    uint32_t changed = 0;
+
+    if (count > HVAC_JOURNAL_MAX_KEYS) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint8_t key = entries[i].key;
+        if (key >= HVAC_JOURNAL_MAX_KEYS || (seen & (1u << key))) {
+            return false;
+        }
+        seen |= 1u << key;
+        if (!(journal->valid & (1u << key)) || journal->values[key] != entries[i].value) {
+            changed++;
+        }
+    }
+    if (changed == 0) {
+        journal->stats.sets_unchanged++;
+        return true;
+    }
+
+    if (journal->write_offset + (changed + 1) * HVAC_JOURNAL_SLOT_SIZE > HVAC_JOURNAL_SECTOR_SIZE) {
+        // Set does not fit: the snapshot in the next sector carries the new values
+        uint32_t old_values[HVAC_JOURNAL_MAX_KEYS];
+        uint32_t old_valid = journal->valid;
+        memcpy(old_values, journal->values, sizeof(old_values));
+        for (size_t i = 0; i < count; i++) {
+            journal->values[entries[i].key] = entries[i].value;
+            journal->valid |= 1u << entries[i].key;
+        }
+
+        uint32_t next = (journal->active_sector + 1) % journal->sector_count;
+        if (!hvac_journal_start_sector(journal, next, journal->seq + 1)) {
+            memcpy(journal->values, old_values, sizeof(old_values));
+            journal->valid = old_valid;
+            return false;
+        }
+        journal->stats.sets_committed++;
+        return true;
+    }
+
+    uint32_t base = journal->active_sector * HVAC_JOURNAL_SECTOR_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        uint8_t key = entries[i].key;
+        if ((journal->valid & (1u << key)) && journal->values[key] == entries[i].value) {
+            continue;
+        }
+        // The slot is used even if the write fails half way (it cannot be rewritten)
+        uint32_t offset = base + journal->write_offset;
+        journal->write_offset += HVAC_JOURNAL_SLOT_SIZE;
+        if (!hvac_journal_write_slot(journal, offset, key, entries[i].value)) {
+            return false;
+        }
+    }
+
+    // Until this record lands replay ignores the records above
+    uint32_t offset = base + journal->write_offset;
+    journal->write_offset += HVAC_JOURNAL_SLOT_SIZE;
+    if (!hvac_journal_write_slot(journal, offset, HVAC_JOURNAL_KEY_COMMIT, changed)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        journal->values[entries[i].key] = entries[i].value;
+        journal->valid |= 1u << entries[i].key;
+    }
+    journal->stats.sets_committed++;
+    return true;
+}
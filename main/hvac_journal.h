@@ -0,0 +1,140 @@
+/*
+ * HVAC Settings Journal Header
+ *
+ * Append-only, power-loss-safe key/value journal for the persisted settings.
+ * Plain C with no ESP-IDF dependencies so it can be run against a simulated
+ * flash on the host. Flash access goes through hvac_journal_flash_t.
+ *
+ * The region is split into sectors used round-robin. Every record is one
+ * 8-byte slot with its own CRC, written once into erased flash:
+ *
+ * [0]    Key (HVAC_JOURNAL_KEY_SECTOR, _SNAPSHOT, _COMMIT or a user key)
+ * [1]    Reserved (0x00, so a written slot is never all 0xFF)
+ * [2-3]  CRC16 over bytes [0-1] and [4-7]
+ * [4-7]  Value, little endian
+ *
+ * A sector starts with a SECTOR record (value = sequence number), then the
+ * latest value of every key, then a SNAPSHOT record that marks the sector
+ * complete. After that every change set is one record per changed key
+ * followed by a COMMIT record (value = number of records in the set). When
+ * the active sector is full the next one is erased and started the same
+ * way, so only the newest complete sector is needed at boot and each sector
+ * is erased once per lap.
+ *
+ * Replay only applies user records once their SNAPSHOT or COMMIT record is
+ * found, so a change set is all-or-nothing. A power cut can leave at most
+ * one torn slot (skipped on replay thanks to its CRC), the records of a set
+ * without its COMMIT (never applied), or an incomplete sector without
+ * SNAPSHOT record (ignored, the previous sector is still intact).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HVAC_JOURNAL_SECTOR_SIZE    4096
+#define HVAC_JOURNAL_SLOT_SIZE      8
+#define HVAC_JOURNAL_MAX_KEYS       16      // User keys are 0 .. HVAC_JOURNAL_MAX_KEYS-1
+
+/* Reserved keys */
+#define HVAC_JOURNAL_KEY_COMMIT     0xFC
+#define HVAC_JOURNAL_KEY_SECTOR     0xFD
+#define HVAC_JOURNAL_KEY_SNAPSHOT   0xFE
+
+/* Flash access. Callbacks return 0 on success (esp_err_t compatible).
+ * Offsets are relative to the start of the region. */
+typedef struct {
+    int (*read)(void *ctx, uint32_t offset, void *buf, size_t len);
+    int (*write)(void *ctx, uint32_t offset, const void *buf, size_t len);
+    int (*erase_sector)(void *ctx, uint32_t offset);
+    void *ctx;
+    uint32_t size;              // Region size, a multiple of HVAC_JOURNAL_SECTOR_SIZE (>= 2 sectors)
+} hvac_journal_flash_t;
+
+/* Journal statistics */
+typedef struct {
+    uint32_t records_written;   // Records appended since mount (snapshots and commits included)
+    uint32_t sets_committed;    // Change sets made durable since mount
+    uint32_t sets_unchanged;    // Change sets that changed no value (nothing written)
+    uint32_t records_replayed;  // Records applied at mount
+    uint32_t torn_records;      // Slots with a bad CRC found at mount
+    uint32_t sector_erases;     // Sectors erased since mount
+} hvac_journal_stats_t;
+
+/* One key of a change set */
+typedef struct {
+    uint8_t key;
+    uint32_t value;
+} hvac_journal_entry_t;
+
+/* Journal instance */
+typedef struct {
+    hvac_journal_flash_t flash;
+    uint32_t sector_count;
+    uint32_t active_sector;
+    uint32_t write_offset;      // Next free slot in the active sector
+    uint32_t seq;               // Sequence number of the active sector
+    uint32_t values[HVAC_JOURNAL_MAX_KEYS];
+    uint32_t valid;             // Bit n set when key n has a value
+    hvac_journal_stats_t stats;
+} hvac_journal_t;
+
+/**
+ * @brief Mount a journal region and replay it
+ *
+ * Picks the complete sector with the highest sequence number and loads the
+ * latest value of each key. An empty or unreadable region is formatted.
+ *
+ * @param journal Journal instance to initialize
+ * @param flash Flash access for the region (copied)
+ * @return true on success, false on a flash error or bad region size
+ */
+bool hvac_journal_mount(hvac_journal_t *journal, const hvac_journal_flash_t *flash);
+
+/**
+ * @brief Get the current value of a key
+ *
+ * @param journal Mounted journal
+ * @param key User key
+ * @param value Set to the value if present
+ * @return true if the key has a value
+ */
+bool hvac_journal_get(const hvac_journal_t *journal, uint8_t key, uint32_t *value);
+
+/**
+ * @brief Record a new value for a key
+ *
+ * Same as hvac_journal_set_many() with a single entry.
+ *
+ * @param journal Mounted journal
+ * @param key User key
+ * @param value New value
+ * @return true once the value is durable, false on a flash error or bad key
+ */
+bool hvac_journal_set(hvac_journal_t *journal, uint8_t key, uint32_t value);
+
+/**
+ * @brief Record new values for several keys as one change set
+ *
+ * Only keys whose value changes are written, followed by one COMMIT
+ * record; nothing is written if no value changes. After a power cut the
+ * journal holds either every value of the set or none of them. Rotates to
+ * the next sector (one erase) when the set does not fit in the active one.
+ *
+ * @param journal Mounted journal
+ * @param entries Keys and values, each key at most once
+ * @param count Number of entries (at most HVAC_JOURNAL_MAX_KEYS)
+ * @return true once the set is durable, false on a flash error, a bad key
+ *         or a repeated key
+ */
+bool hvac_journal_set_many(hvac_journal_t *journal, const hvac_journal_entry_t *entries, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
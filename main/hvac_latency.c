@@ -0,0 +1,110 @@
+/*
+ * HVAC Command Latency Instrumentation Implementation
+ */
+
+#include "hvac_latency.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+static const char *TAG = "HVAC_LATENCY";
+
+static const uint32_t bucket_bounds_ms[HVAC_LAT_BUCKET_COUNT - 1] = HVAC_LAT_BUCKET_BOUNDS_MS;
+
+/* Stage timestamps of the command in flight (0 = not reached) */
+static int64_t stage_time_us[HVAC_LAT_ATTRIBUTES + 1];
+static hvac_latency_hist_t hist = {0};
+
+/* Stages are marked from the Zigbee, TX and RX tasks */
+static portMUX_TYPE latency_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Add one interval to a histogram
+ */
+static void hvac_latency_record(hvac_latency_hist_id_t id, int64_t interval_us)
+{
+    uint32_t ms = (uint32_t)(interval_us / 1000);
+    size_t bucket = 0;
+
+    while (bucket < HVAC_LAT_BUCKET_COUNT - 1 && ms > bucket_bounds_ms[bucket]) {
+        bucket++;
+    }
+    if (hist.buckets[id][bucket] < UINT16_MAX) {
+        hist.buckets[id][bucket]++;
+    }
+}
+
+/**
+ * @brief Timestamp a stage of the command currently in flight
+ */
+bool hvac_latency_mark(hvac_latency_stage_t stage)
+{
+    int64_t now = esp_timer_get_time();
+    bool completed = false;
+    int64_t total_us = 0;
+
+    portENTER_CRITICAL(&latency_lock);
+    if (stage == HVAC_LAT_HANDLER) {
+        memset(stage_time_us, 0, sizeof(stage_time_us));
+        stage_time_us[HVAC_LAT_HANDLER] = now;
+    } else if (stage_time_us[stage - 1] != 0 && stage_time_us[stage] == 0) {
+        stage_time_us[stage] = now;
+        hvac_latency_record((hvac_latency_hist_id_t)(stage - 1), now - stage_time_us[stage - 1]);
+
+        if (stage == HVAC_LAT_ATTRIBUTES) {
+            total_us = now - stage_time_us[HVAC_LAT_HANDLER];
+            hvac_latency_record(HVAC_LAT_HIST_TOTAL, total_us);
+            hist.completed++;
+            memset(stage_time_us, 0, sizeof(stage_time_us));
+            completed = true;
+        }
+    }
+    portEXIT_CRITICAL(&latency_lock);
+
+    if (completed) {
+        ESP_LOGI(TAG, "Command round trip: %lu ms (Zigbee write -> attributes set)",
+                 (unsigned long)(total_us / 1000));
+    }
+    return completed;
+}
+
+/**
+ * @brief Copy the histograms
+ */
+esp_err_t hvac_latency_get(hvac_latency_hist_t *out)
+{
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&latency_lock);
+    *out = hist;
+    portEXIT_CRITICAL(&latency_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief Serialize the histograms for an octet string attribute
+ */
+size_t hvac_latency_serialize(uint8_t *buf, size_t len)
+{
+    if (!buf || len < HVAC_LAT_SERIALIZED_LEN) {
+        return 0;
+    }
+
+    hvac_latency_hist_t snapshot;
+    hvac_latency_get(&snapshot);
+
+    uint8_t *p = buf;
+    *p++ = HVAC_LAT_SERIALIZED_VERSION;
+    *p++ = HVAC_LAT_HIST_COUNT;
+    *p++ = HVAC_LAT_BUCKET_COUNT;
+    for (size_t i = 0; i < HVAC_LAT_HIST_COUNT; i++) {
+        for (size_t b = 0; b < HVAC_LAT_BUCKET_COUNT; b++) {
+            *p++ = snapshot.buckets[i][b] & 0xFF;
+            *p++ = snapshot.buckets[i][b] >> 8;
+        }
+    }
+    return p - buf;
+}
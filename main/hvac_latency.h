@@ -0,0 +1,84 @@
+/*
+ * HVAC Command Latency Instrumentation Header
+ * 
+ * Timestamps the stages of a Zigbee command on its way to the AC and back
+ * and keeps a fixed-bucket histogram per stage in RAM.
+ * 
+ * Stages (marked in this order for one command):
+ *   HANDLER    - ESP_ZB_CORE_SET_ATTR_VALUE_CB_ID handler entry
+ *   WIRE       - control frame written to the UART
+ *   DECODED    - next 34-byte status frame decoded
+ *   ATTRIBUTES - Zigbee attributes updated from that status
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HVAC_LAT_HANDLER = 0,
+    HVAC_LAT_WIRE,
+    HVAC_LAT_DECODED,
+    HVAC_LAT_ATTRIBUTES,
+} hvac_latency_stage_t;
+
+/* Histogram intervals */
+typedef enum {
+    HVAC_LAT_HIST_HANDLER_TO_WIRE = 0,
+    HVAC_LAT_HIST_WIRE_TO_DECODED,
+    HVAC_LAT_HIST_DECODED_TO_ATTRIBUTES,
+    HVAC_LAT_HIST_TOTAL,                    // Handler entry -> attributes set
+    HVAC_LAT_HIST_COUNT
+} hvac_latency_hist_id_t;
+
+/* Bucket upper bounds in ms; the last bucket collects everything above */
+#define HVAC_LAT_BUCKET_BOUNDS_MS   { 10, 20, 50, 100, 200, 500, 1000, 2000, 5000 }
+#define HVAC_LAT_BUCKET_COUNT       10
+
+/* Serialized histogram: version, stage count, bucket count, then uint16 LE counts */
+#define HVAC_LAT_SERIALIZED_VERSION 1
+#define HVAC_LAT_SERIALIZED_LEN     (3 + HVAC_LAT_HIST_COUNT * HVAC_LAT_BUCKET_COUNT * 2)
+
+typedef struct {
+    uint16_t buckets[HVAC_LAT_HIST_COUNT][HVAC_LAT_BUCKET_COUNT];   // Saturating counts
+    uint32_t completed;                                             // Commands measured end to end
+} hvac_latency_hist_t;
+
+/**
+ * @brief Timestamp a stage of the command currently in flight
+ * 
+ * HANDLER starts a new measurement. Later stages are only recorded if the
+ * previous stage was, so unsolicited status frames are ignored.
+ * 
+ * @param stage Stage reached
+ * @return true if this mark completed a measurement (ATTRIBUTES)
+ */
+bool hvac_latency_mark(hvac_latency_stage_t stage);
+
+/**
+ * @brief Copy the histograms
+ * 
+ * @param hist Destination
+ * @return ESP_OK on success
+ */
+esp_err_t hvac_latency_get(hvac_latency_hist_t *hist);
+
+/**
+ * @brief Serialize the histograms for an octet string attribute
+ * 
+ * @param buf Destination, at least HVAC_LAT_SERIALIZED_LEN bytes
+ * @param len Size of buf
+ * @return Number of bytes written, 0 if buf is too small
+ */
+size_t hvac_latency_serialize(uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+/*
+ * HVAC Shadow Tracker Implementation
+ */
+
+#include "hvac_shadow_tracker.h"
+
+/**
+ * @brief Start tracking a new request
+ */
+bool hvac_shadow_track_request(hvac_shadow_tracker_t *tracker, uint32_t pending, int64_t now_us)
+{
+    tracker->pending = pending;
+    tracker->attempts = 1;
+    tracker->sent_us = now_us;
+    return pending != 0;
+}
+
+/**
+ * @brief Account for a decoded status frame
+ */
+bool hvac_shadow_track_report(hvac_shadow_tracker_t *tracker, uint32_t differs)
+{
+    if (tracker->pending == 0) {
+        return false;
+    }
+
+    tracker->pending &= differs;
+    if (tracker->pending != 0) {
+        return false;
+    }
+    tracker->converged++;
+    return true;
+}
+
+/**
+ * @brief Decide whether the pending request has to be re-sent or rolled back
+ */
+hvac_shadow_action_t hvac_shadow_track_poll(hvac_shadow_tracker_t *tracker, int64_t now_us)
+{
+    if (tracker->pending == 0 ||
+        now_us - tracker->sent_us < (int64_t)HVAC_SHADOW_RESEND_MS * 1000) {
+        return HVAC_SHADOW_WAIT;
+    }
+
+    if (tracker->attempts < HVAC_SHADOW_MAX_ATTEMPTS) {
+        tracker->attempts++;
+        tracker->resends++;
+        tracker->sent_us = now_us;
+        return HVAC_SHADOW_RESEND;
+    }
+
+    tracker->pending = 0;
+    tracker->rollbacks++;
+    return HVAC_SHADOW_ROLLBACK;
+}
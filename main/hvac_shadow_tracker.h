@@ -0,0 +1,79 @@
+/*
+ * HVAC Shadow Tracker Header
+ *
+ * Resend/rollback bookkeeping for a request the AC has not confirmed yet.
+ * Plain C with no ESP-IDF dependencies so the timeline (lost frames,
+ * resends, rollback) can be replayed on the host. The driver owns the
+ * desired state and the mutex; the tracker only sees field masks and time.
+ *
+ * A request is sent once when it is made (attempt 1). Every
+ * HVAC_SHADOW_RESEND_MS without a matching status frame it is sent again,
+ * up to HVAC_SHADOW_MAX_ATTEMPTS frames, then rolled back.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HVAC_SHADOW_RESEND_MS       1500    // Re-send when the AC has not converged after this long
+#define HVAC_SHADOW_MAX_ATTEMPTS    3       // Control frames sent before rolling back
+#define HVAC_SHADOW_POLL_MS         250     // Command task wake-up while a request is pending
+
+/* What the owner of the tracker has to do now */
+typedef enum {
+    HVAC_SHADOW_WAIT = 0,       // Nothing pending, or the last frame is still recent
+    HVAC_SHADOW_RESEND,         // Send the desired state again
+    HVAC_SHADOW_ROLLBACK,       // Give up, publish the reported state
+} hvac_shadow_action_t;
+
+/* Tracker instance */
+typedef struct {
+    uint32_t pending;           // Fields where the AC has not converged yet
+    uint8_t attempts;           // Control frames sent for the pending request
+    int64_t sent_us;            // When the last one was sent
+    uint32_t converged;         // Requests confirmed by the AC
+    uint32_t resends;           // Control frames re-sent
+    uint32_t rollbacks;         // Requests abandoned
+} hvac_shadow_tracker_t;
+
+/**
+ * @brief Start tracking a new request (its first frame goes out now)
+ *
+ * Replaces any request still pending.
+ *
+ * @param tracker Tracker instance
+ * @param pending Fields the AC does not report yet (0 = already matches)
+ * @param now_us Current time
+ * @return true if the request is pending and must be polled
+ */
+bool hvac_shadow_track_request(hvac_shadow_tracker_t *tracker, uint32_t pending, int64_t now_us);
+
+/**
+ * @brief Account for a decoded status frame
+ *
+ * @param tracker Tracker instance
+ * @param differs Fields where the reported state still differs from the desired one
+ * @return true if this frame completed the pending request
+ */
+bool hvac_shadow_track_report(hvac_shadow_tracker_t *tracker, uint32_t differs);
+
+/**
+ * @brief Decide whether the pending request has to be re-sent or rolled back
+ *
+ * RESEND counts the new attempt and restarts the timer; ROLLBACK clears the
+ * pending fields.
+ *
+ * @param tracker Tracker instance
+ * @param now_us Current time
+ * @return Action for the caller
+ */
+hvac_shadow_action_t hvac_shadow_track_poll(hvac_shadow_tracker_t *tracker, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
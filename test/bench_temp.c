@@ -0,0 +1,124 @@
+/*
+ * Ambient temperature conversion benchmark: float degrees vs int16 centi-degrees
+ *
+ * Replays the decode -> change detection -> ZCL conversion path for every
+ * (integer, tenths) pair the AC can report, once with the float pipeline
+ * the driver used to have and once with the centi-degree pipeline it uses
+ * now. On the ESP32-C6 (RV32IMAC, no FPU) the float path costs seven
+ * soft-float calls per reading (2x __floatsisf, __divsf3, __addsf3,
+ * __nesf2, __mulsf3, __fixsfsi); a host with an FPU runs both paths at
+ * about the same speed, so the host ratio is only a lower bound.
+ *
+ * Also checks that the centi-degree path is exact: the float path truncates
+ * values like 25.3 * 100 to 2529.
+ */
+
+#include "hvac_test.h"
+#include <stdint.h>
+#include <time.h>
+
+#define BENCH_ROUNDS    20000
+#define TEMP_INT_MAX    50
+
+/* State fields as the driver keeps them */
+typedef struct {
+    float ambient_temp_c;
+} float_state_t;
+
+typedef struct {
+    int16_t ambient_temp_cd;
+} cd_state_t;
+
+static volatile uint32_t sink;
+
+/**
+ * @brief Old path: float decode, float compare, scale to ZCL centi-degrees
+ */
+static __attribute__((noinline)) int16_t float_path(float_state_t *state, uint8_t temp_int, uint8_t temp_dec)
+{
+    float prev = state->ambient_temp_c;
+    state->ambient_temp_c = (float)temp_int + ((float)temp_dec / 10.0f);
+    if (prev != state->ambient_temp_c) {
+        sink++;
+    }
+    return state->ambient_temp_c * 100;
+}
+
+/**
+ * @brief New path: centi-degrees from the frame bytes, integer compare, no scaling
+ */
+static __attribute__((noinline)) int16_t cd_path(cd_state_t *state, uint8_t temp_int, uint8_t temp_dec)
+{
+    int16_t prev = state->ambient_temp_cd;
+    state->ambient_temp_cd = (int16_t)(temp_int * 100 + temp_dec * 10);
+    if (prev != state->ambient_temp_cd) {
+        sink++;
+    }
+    return state->ambient_temp_cd;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void test_cd_path_exact(void)
+{
+    cd_state_t cd = {0};
+    float_state_t fl = {0};
+    uint32_t float_off = 0;
+
+    for (uint8_t t = 0; t <= TEMP_INT_MAX; t++) {
+        for (uint8_t d = 0; d < 10; d++) {
+            int16_t exact = t * 100 + d * 10;
+            CHECK_EQ(cd_path(&cd, t, d), exact);
+            if (float_path(&fl, t, d) != exact) {
+                float_off++;
+            }
+        }
+    }
+    printf("float path off by 0.01 degC on %lu of %d readings\n",
+           (unsigned long)float_off, (TEMP_INT_MAX + 1) * 10);
+}
+
+static void bench(void)
+{
+    cd_state_t cd = {0};
+    float_state_t fl = {0};
+    uint32_t acc = 0;
+    const uint32_t conversions = BENCH_ROUNDS * (TEMP_INT_MAX + 1) * 10;
+
+    uint64_t start = now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (uint8_t t = 0; t <= TEMP_INT_MAX; t++) {
+            for (uint8_t d = 0; d < 10; d++) {
+                acc += float_path(&fl, t, d);
+            }
+        }
+    }
+    uint64_t float_ns = now_ns() - start;
+
+    start = now_ns();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (uint8_t t = 0; t <= TEMP_INT_MAX; t++) {
+            for (uint8_t d = 0; d < 10; d++) {
+                acc += cd_path(&cd, t, d);
+            }
+        }
+    }
+    uint64_t cd_ns = now_ns() - start;
+    sink += acc;
+
+    printf("float:         %6.2f ns/conversion\n", (double)float_ns / conversions);
+    printf("centi-degrees: %6.2f ns/conversion\n", (double)cd_ns / conversions);
+    printf("ratio:         %6.2fx\n", cd_ns ? (double)float_ns / cd_ns : 0.0);
+}
+
+int main(void)
+{
+    RUN(test_cd_path_exact);
+    bench();
+    return TEST_RESULT();
+}
@@ -0,0 +1,32 @@
+/*
+ * Minimal assertion helpers for the host tests
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+static int hvac_test_failures;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+        hvac_test_failures++; \
+    } \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+    unsigned long _a = (unsigned long)(actual), _e = (unsigned long)(expected); \
+    if (_a != _e) { \
+        printf("%s:%d: CHECK_EQ failed: %s = 0x%lX, expected 0x%lX\n", __FILE__, __LINE__, #actual, _a, _e); \
+        hvac_test_failures++; \
+    } \
+} while (0)
+
+#define RUN(test) do { \
+    int _before = hvac_test_failures; \
+    test(); \
+    printf("%-44s %s\n", #test, hvac_test_failures == _before ? "ok" : "FAILED"); \
+} while (0)
+
+#define TEST_RESULT() (hvac_test_failures == 0 ? 0 : 1)
@@ -0,0 +1,29 @@
+/*
+ * Golden ACW02 frames shared by the host tests (CRC16 Modbus, MSB first)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Keepalive request sent by the driver (12 bytes, TX only) */
+static const uint8_t golden_keepalive[] = {
+    0x7A, 0x7A, 0x21, 0xD5, 0x0C, 0x00, 0x00, 0xAB, 0x0A, 0x0A, 0xFC, 0xF9,
+};
+
+/* Status request sent by the driver (12 bytes, TX only) */
+static const uint8_t golden_get_status[] = {
+    0x7A, 0x7A, 0x21, 0xD5, 0x0C, 0x00, 0x00, 0xA2, 0x0A, 0x0A, 0xFE, 0x29,
+};
+
+/* Command acknowledgment from the AC (13 bytes) */
+static const uint8_t golden_ack[] = {
+    0x7A, 0x7A, 0xD1, 0x21, 0x0D, 0x00, 0x00, 0xA4, 0x0A, 0x0A, 0x00, 0x25, 0x25,
+};
+
+/* Status report from the AC (34 bytes) */
+static const uint8_t golden_status[] = {
+    0x7A, 0x7A, 0xD5, 0x21, 0x22, 0x00, 0x00, 0xA2, 0x0A, 0x0A, 0x01, 0x18,
+    0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x17, 0x05, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x58, 0xB2,
+};
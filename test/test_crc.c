@@ -0,0 +1,85 @@
+/*
+ * CRC16 golden vectors (built once per HVAC_CRC16_IMPL variant)
+ */
+
+#include "hvac_crc.h"
+#include "hvac_test.h"
+#include "hvac_test_frames.h"
+#include <string.h>
+
+/**
+ * @brief CRC carried in the last two bytes of a frame (MSB first)
+ */
+static uint16_t frame_crc(const uint8_t *frame, size_t len)
+{
+    return (frame[len - 2] << 8) | frame[len - 1];
+}
+
+static void test_check_value(void)
+{
+    const uint8_t check[] = "123456789";
+    CHECK_EQ(hvac_crc16(check, 9), 0x4B37);     // CRC-16/MODBUS check value
+    CHECK_EQ(hvac_crc16(check, 0), 0xFFFF);
+}
+
+static void test_golden_frames(void)
+{
+    CHECK_EQ(hvac_crc16(golden_keepalive, sizeof(golden_keepalive) - 2), frame_crc(golden_keepalive, sizeof(golden_keepalive)));
+    CHECK_EQ(hvac_crc16(golden_get_status, sizeof(golden_get_status) - 2), frame_crc(golden_get_status, sizeof(golden_get_status)));
+    CHECK_EQ(hvac_crc16(golden_ack, sizeof(golden_ack) - 2), 0x2525);
+    CHECK_EQ(hvac_crc16(golden_status, sizeof(golden_status) - 2), 0x58B2);
+}
+
+static void test_split_update(void)
+{
+    // A frame split across the ring wrap must give the same CRC at every split point
+    size_t body = sizeof(golden_status) - 2;
+    for (size_t split = 0; split <= body; split++) {
+        uint16_t crc = hvac_crc16_update(0xFFFF, golden_status, split);
+        crc = hvac_crc16_update(crc, &golden_status[split], body - split);
+        CHECK_EQ(crc, 0x58B2);
+    }
+}
+
+/**
+ * @brief Reference CRC16 (Modbus), bit by bit, independent of hvac_crc.c
+ */
+static uint16_t reference_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+static void test_matches_reference(void)
+{
+    uint8_t buf[256];
+    uint32_t seed = 0x12345678;
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        seed = seed * 1103515245u + 12345u;
+        buf[i] = seed >> 16;
+    }
+
+    for (size_t len = 0; len <= sizeof(buf); len++) {
+        CHECK_EQ(hvac_crc16(buf, len), reference_crc16(buf, len));
+    }
+    for (int byte = 0; byte < 256; byte++) {
+        uint8_t b = byte;
+        CHECK_EQ(hvac_crc16(&b, 1), reference_crc16(&b, 1));
+    }
+}
+
+int main(void)
+{
+    printf("HVAC_CRC16_IMPL=%d\n", HVAC_CRC16_IMPL);
+    RUN(test_check_value);
+    RUN(test_golden_frames);
+    RUN(test_split_update);
+    RUN(test_matches_reference);
+    return TEST_RESULT();
+}
@@ -0,0 +1,169 @@
+/*
+ * Warning code lookup: every code byte against the original decoder
+ *
+ * The reference below is the nibble -> letter/digit if-chain and linear
+ * table scan the driver used before the compile-time index, kept verbatim
+ * apart from returning the matched entry instead of formatting a string.
+ */
+
+#include "hvac_error_codes.h"
+#include "hvac_test.h"
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t code_high;
+    uint8_t code_low;
+    const char *description;
+} reference_entry_t;
+
+/* Error code table as it was in hvac_driver.c */
+static const reference_entry_t reference_table[] = {
+    {'C', 'L', "Filter cleaning reminder"},
+    {'D', '0', "Compressor RMS phase current limit"},
+    {'D', '1', "Low RMS machine current limit"},
+    {'D', '2', "Lower gas discharge temperature limit"},
+    {'D', '3', "Extreme anti-freeze limit"},
+    {'D', '4', "Overload limit"},
+    {'D', '5', "IPM power module temperature limit"},
+    {'E', '0', "Protection against high discharge temperatures"},
+    {'E', '1', "Overload protection"},
+    {'E', '2', "Compressor overload protection"},
+    {'E', '3', "Frost protection"},
+    {'E', '7', "4-way valve malfunction"},
+    {'E', '8', "Abnormal outdoor ambient temperature"},
+    {'H', '0', "Compressor stalling or jamming"},
+    {'H', '1', "Startup failure"},
+    {'H', '2', "Compressor phase current peak protection"},
+    {'H', '3', "Compressor phase current RMS protection"},
+    {'H', '4', "IPM power module protection"},
+    {'H', '5', "IPM overheat protection"},
+    {'H', '6', "Compressor circuit phase detection error"},
+    {'H', '7', "Compressor phase loss error"},
+    {'H', '8', "Outdoor unit fan motor error"},
+    {'H', '9', "Outdoor unit fan motor phase current detection circuit error"},
+    {'L', '0', "Jumper error"},
+    {'L', '1', "Indoor fan motor zero crossing detection circuit malfunction"},
+    {'L', '2', "Indoor fan motor error"},
+    {'L', '3', "Communication fault between indoor and outdoor unit"},
+    {'L', '4', "Port selection error"},
+    {'L', '5', "EEPROM error on indoor unit"},
+    {'L', '6', "Communication fault between outdoor and indoor unit"},
+    {'L', 'L', "Function test"},
+    {'P', '0', "EEPROM error on outdoor unit"},
+    {'P', '1', "Power on error"},
+    {'P', '2', "AC current protection"},
+    {'P', '3', "High voltage protection"},
+    {'P', '4', "Low voltage protection"},
+    {'P', '5', "DC DC line voltage drop protection"},
+    {'P', '6', "Current detection circuit error"},
+    {'P', '7', "Overcurrent protection"},
+    {'P', '8', "PFC current detection circuit error"},
+    {'P', '9', "PFC protection"},
+    {'P', 'A', "IU and EU mismatch"},
+    {'P', 'C', "Fashion Conflict"},
+    {'U', '0', "Ambient temperature sensor (probe) open/closed circuit"},
+    {'U', '1', "Pipe temperature sensor (probe) open/closed circuit"},
+    {'U', '2', "Ambient temperature sensor (probe) open/closed circuit"},
+    {'U', '3', "UE Discharge Sensor (Probe) Open/Closed Circuit"},
+    {'U', '4', "UE pipe temperature sensor open/closed circuit (probe)"},
+    {'U', '5', "IPM power module temperature sensor open/closed circuit"},
+    {'U', '6', "Liquid pipe outlet temperature sensor open/closed circuit"},
+    {'U', '7', "Gas pipe outlet temperature sensor open/closed circuit"},
+    {'U', '8', "Discharge temperature sensor open/closed circuit"},
+};
+
+#define REFERENCE_TABLE_SIZE (sizeof(reference_table) / sizeof(reference_entry_t))
+
+/**
+ * @brief Original decoder: nibble if-chain, then linear scan
+ *
+ * @return Matching table entry, NULL for an unknown code (0x80 maps to CL)
+ */
+static const reference_entry_t *reference_decode(uint8_t code)
+{
+    if (code == 0x80) {
+        return &reference_table[0];
+    }
+
+    uint8_t code_high = (code >> 4) & 0x0F;
+    uint8_t code_low = code & 0x0F;
+    char high_char = 0, low_char = 0;
+
+    if (code_high >= 0x0C && code_high <= 0x0F) {
+        high_char = 'C' + (code_high - 0x0C);
+    } else if (code_high >= 0x08 && code_high <= 0x0B) {
+        high_char = 'H' + (code_high - 0x08);
+    } else if (code_high >= 0x04 && code_high <= 0x07) {
+        high_char = 'L' + (code_high - 0x04);
+    } else if (code_high <= 0x03) {
+        high_char = 'P' + (code_high - 0x00);
+    }
+
+    if (code_low <= 9) {
+        low_char = '0' + code_low;
+    } else {
+        low_char = 'A' + (code_low - 10);
+    }
+
+    for (size_t i = 0; i < REFERENCE_TABLE_SIZE; i++) {
+        if (reference_table[i].code_high == high_char &&
+            reference_table[i].code_low == low_char) {
+            return &reference_table[i];
+        }
+    }
+    return NULL;
+}
+
+static void test_every_code_byte(void)
+{
+    int known = 0;
+
+    for (int code = 0; code < 256; code++) {
+        const reference_entry_t *ref = reference_decode(code);
+        hvac_error_code_id_t id = hvac_error_code_id(code);
+        const char *name = hvac_error_code_name(code);
+        const char *text = hvac_error_code_text(code);
+
+        if (ref == NULL) {
+            CHECK_EQ(id, HVAC_ERR_UNKNOWN);
+            CHECK(strcmp(name, "??") == 0);
+            CHECK(strcmp(text, "Unknown error code") == 0);
+            continue;
+        }
+
+        known++;
+        CHECK(id != HVAC_ERR_UNKNOWN && id < HVAC_ERR_COUNT);
+        CHECK_EQ(strlen(name), 2);
+        CHECK_EQ(name[0], ref->code_high);
+        CHECK_EQ(name[1], ref->code_low);
+        if (code == 0x80) {
+            CHECK_EQ(id, HVAC_ERR_CL);
+            CHECK(strcmp(text, "Filter cleaning reminder (CL)") == 0);
+        } else if (strcmp(text, ref->description) != 0) {
+            printf("code 0x%02X: \"%s\", expected \"%s\"\n", code, text, ref->description);
+            hvac_test_failures++;
+        }
+    }
+
+    // 0x80 plus the 40 P/L/H/D/E entries reachable from the nibble encoding
+    CHECK_EQ(known, 41);
+}
+
+static void test_known_codes(void)
+{
+    CHECK_EQ(hvac_error_code_id(0x80), HVAC_ERR_CL);
+    CHECK_EQ(hvac_error_code_id(0x00), HVAC_ERR_P0);
+    CHECK_EQ(hvac_error_code_id(0x0C), HVAC_ERR_PC);
+    CHECK_EQ(hvac_error_code_id(0x81), HVAC_ERR_H1);
+    CHECK_EQ(hvac_error_code_id(0xE1), HVAC_ERR_E1);
+    CHECK(strcmp(hvac_error_code_name(0xE1), "E1") == 0);
+    CHECK_EQ(hvac_error_code_id(0xFF), HVAC_ERR_UNKNOWN);
+}
+
+int main(void)
+{
+    RUN(test_every_code_byte);
+    RUN(test_known_codes);
+    return TEST_RESULT();
+}
@@ -0,0 +1,339 @@
+/*
+ * Frame parser vectors: golden frames, resync, ring wrap-around,
+ * fragmented feeds, leading garbage, random line noise and ring overflow
+ */
+
+#include "hvac_frame_parser.h"
+#include "hvac_test.h"
+#include "hvac_test_frames.h"
+#include <string.h>
+
+/* Frames delivered to the handler, flattened out of the ring */
+typedef struct {
+    uint8_t last[HVAC_FRAME_MAX_LEN];
+    size_t last_len;
+    uint32_t count;
+    uint32_t wrapped;           // Frames delivered as two segments
+    uint32_t mismatches;        // Frames that differ from the expected bytes
+    const uint8_t *expect;
+    size_t expect_len;
+} capture_t;
+
+static void capture_handler(const hvac_frame_view_t *frame, void *ctx)
+{
+    capture_t *cap = ctx;
+
+    cap->last_len = hvac_frame_view_len(frame);
+    for (size_t i = 0; i < cap->last_len; i++) {
+        cap->last[i] = hvac_frame_view_byte(frame, i);
+    }
+    cap->count++;
+    if (frame->seg_len[1] != 0) {
+        cap->wrapped++;
+    }
+    if (cap->expect && (cap->last_len != cap->expect_len || memcmp(cap->last, cap->expect, cap->expect_len) != 0)) {
+        cap->mismatches++;
+    }
+}
+
+static hvac_frame_parser_t parser;
+
+static void test_golden_frames(void)
+{
+    capture_t cap = {0};
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    hvac_frame_parser_feed(&parser, golden_status, sizeof(golden_status));
+    CHECK_EQ(cap.count, 1);
+    CHECK_EQ(cap.last_len, sizeof(golden_status));
+    CHECK(memcmp(cap.last, golden_status, sizeof(golden_status)) == 0);
+
+    hvac_frame_parser_feed(&parser, golden_ack, sizeof(golden_ack));
+    CHECK_EQ(cap.count, 2);
+    CHECK_EQ(cap.last_len, sizeof(golden_ack));
+    CHECK(memcmp(cap.last, golden_ack, sizeof(golden_ack)) == 0);
+
+    CHECK_EQ(parser.stats.frames_ok, 2);
+    CHECK_EQ(parser.stats.crc_errors, 0);
+    CHECK_EQ(parser.stats.bytes_discarded, 0);
+}
+
+static void test_unsupported_length(void)
+{
+    // Our own TX frames announce 12 bytes, which the parser must not accept
+    capture_t cap = {0};
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    hvac_frame_parser_feed(&parser, golden_keepalive, sizeof(golden_keepalive));
+    CHECK_EQ(cap.count, 0);
+    CHECK_EQ(parser.stats.length_errors, 1);
+    CHECK(!hvac_frame_len_valid(12));
+    CHECK(hvac_frame_len_valid(13) && hvac_frame_len_valid(18) && hvac_frame_len_valid(28) && hvac_frame_len_valid(34));
+}
+
+static void test_resync_after_crc_error(void)
+{
+    // A corrupted status frame directly followed by a good one
+    uint8_t stream[2 * sizeof(golden_status)];
+    memcpy(stream, golden_status, sizeof(golden_status));
+    stream[15] ^= 0x40;
+    memcpy(&stream[sizeof(golden_status)], golden_status, sizeof(golden_status));
+
+    capture_t cap = { .expect = golden_status, .expect_len = sizeof(golden_status) };
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    hvac_frame_parser_feed(&parser, stream, sizeof(stream));
+    CHECK_EQ(cap.count, 1);
+    CHECK_EQ(cap.mismatches, 0);
+    CHECK_EQ(parser.stats.crc_errors, 1);
+    CHECK_EQ(parser.stats.frames_ok, 1);
+    CHECK_EQ(parser.stats.bytes_discarded, sizeof(golden_status));
+}
+
+static void test_resync_header_inside_truncated_frame(void)
+{
+    // A status frame cut short by a real ack: the ack header sits inside the
+    // bytes of the rejected candidate and must still be found
+    uint8_t stream[20 + sizeof(golden_ack) + 32];
+    memcpy(stream, golden_status, 20);
+    memcpy(&stream[20], golden_ack, sizeof(golden_ack));
+    memset(&stream[20 + sizeof(golden_ack)], 0x00, 32);     // Line noise to complete the bogus 34 bytes
+
+    capture_t cap = { .expect = golden_ack, .expect_len = sizeof(golden_ack) };
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    hvac_frame_parser_feed(&parser, stream, sizeof(stream));
+    CHECK_EQ(cap.count, 1);
+    CHECK_EQ(cap.mismatches, 0);
+    CHECK_EQ(parser.stats.crc_errors, 1);
+}
+
+static void test_resync_double_header(void)
+{
+    // 0x7A 0x7A 0x7A: the first 0x7A is noise, the frame starts one byte later
+    uint8_t stream[1 + sizeof(golden_ack)];
+    stream[0] = HVAC_FRAME_HEADER_BYTE;
+    memcpy(&stream[1], golden_ack, sizeof(golden_ack));
+
+    capture_t cap = { .expect = golden_ack, .expect_len = sizeof(golden_ack) };
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    hvac_frame_parser_feed(&parser, stream, sizeof(stream));
+    CHECK_EQ(cap.count, 1);
+    CHECK_EQ(cap.mismatches, 0);
+    CHECK_EQ(parser.stats.bytes_discarded, 1);
+}
+
+static void test_ring_wrap_around(void)
+{
+    // 34 does not divide the ring size, so frames regularly straddle the end
+    capture_t cap = { .expect = golden_status, .expect_len = sizeof(golden_status) };
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    const uint32_t frames = 4 * HVAC_RX_RING_SIZE / sizeof(golden_status);
+    for (uint32_t i = 0; i < frames; i++) {
+        hvac_frame_parser_feed(&parser, golden_status, sizeof(golden_status));
+    }
+
+    CHECK_EQ(cap.count, frames);
+    CHECK_EQ(cap.mismatches, 0);
+    CHECK(cap.wrapped > 0);
+    CHECK_EQ(parser.stats.crc_errors, 0);
+    CHECK_EQ(parser.stats.overflows, 0);
+}
+
+static void test_wrap_inside_crc(void)
+{
+    // Place the ring end at every offset of a frame, CRC bytes included
+    for (size_t offset = 1; offset < sizeof(golden_status); offset++) {
+        capture_t cap = { .expect = golden_status, .expect_len = sizeof(golden_status) };
+        hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+        parser.head = parser.tail = parser.scan = HVAC_RX_RING_SIZE - offset;
+        hvac_frame_parser_feed(&parser, golden_status, sizeof(golden_status));
+
+        CHECK_EQ(cap.count, 1);
+        CHECK_EQ(cap.wrapped, 1);
+        CHECK_EQ(cap.mismatches, 0);
+    }
+}
+
+static void test_fragmented_feeds(void)
+{
+    // Status, ack, status back to back, fed in every chunk size from 1 to 48
+    uint8_t stream[2 * sizeof(golden_status) + sizeof(golden_ack)];
+    memcpy(stream, golden_status, sizeof(golden_status));
+    memcpy(&stream[sizeof(golden_status)], golden_ack, sizeof(golden_ack));
+    memcpy(&stream[sizeof(golden_status) + sizeof(golden_ack)], golden_status, sizeof(golden_status));
+
+    for (size_t chunk = 1; chunk <= 48; chunk++) {
+        capture_t cap = {0};
+        hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+        for (size_t pos = 0; pos < sizeof(stream); pos += chunk) {
+            size_t n = sizeof(stream) - pos < chunk ? sizeof(stream) - pos : chunk;
+            hvac_frame_parser_feed(&parser, &stream[pos], n);
+        }
+
+        CHECK_EQ(cap.count, 3);
+        CHECK_EQ(cap.last_len, sizeof(golden_status));
+        CHECK(memcmp(cap.last, golden_status, sizeof(golden_status)) == 0);
+        CHECK_EQ(parser.stats.bytes_discarded, 0);
+        CHECK_EQ(parser.stats.crc_errors, 0);
+    }
+}
+
+static void test_fragmented_direct_spans(void)
+{
+    // Same path as the UART task: read straight into the write span, then commit
+    capture_t cap = { .expect = golden_status, .expect_len = sizeof(golden_status) };
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    const size_t splits[] = { 1, 3, 4, 5, 20, 1 };
+    size_t pos = 0;
+    for (size_t i = 0; i < sizeof(splits) / sizeof(splits[0]); i++) {
+        uint8_t *dst;
+        size_t span = hvac_frame_parser_write_span(&parser, &dst);
+        CHECK(span >= splits[i]);
+        memcpy(dst, &golden_status[pos], splits[i]);
+        hvac_frame_parser_commit(&parser, splits[i]);
+        pos += splits[i];
+        CHECK_EQ(cap.count, pos == sizeof(golden_status) ? 1 : 0);
+    }
+    CHECK_EQ(pos, sizeof(golden_status));
+    CHECK_EQ(cap.mismatches, 0);
+}
+
+static void test_garbage_before_header(void)
+{
+    // Noise without any header byte, then a lone header byte, then a frame
+    const uint8_t noise[] = { 0x00, 0xFF, 0x21, 0xD5, 0x22, 0x7B, 0xA5, 0x7A, 0x00, 0x13 };
+    uint8_t stream[sizeof(noise) + sizeof(golden_status)];
+    memcpy(stream, noise, sizeof(noise));
+    memcpy(&stream[sizeof(noise)], golden_status, sizeof(golden_status));
+
+    capture_t cap = { .expect = golden_status, .expect_len = sizeof(golden_status) };
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    hvac_frame_parser_feed(&parser, stream, sizeof(stream));
+    CHECK_EQ(cap.count, 1);
+    CHECK_EQ(cap.mismatches, 0);
+    CHECK_EQ(parser.stats.bytes_discarded, sizeof(noise));
+    CHECK_EQ(parser.stats.crc_errors, 0);
+
+    // Garbage fed one byte at a time between two frames
+    cap.count = 0;
+    for (size_t i = 0; i < sizeof(noise); i++) {
+        hvac_frame_parser_feed(&parser, &noise[i], 1);
+    }
+    hvac_frame_parser_feed(&parser, golden_status, sizeof(golden_status));
+    CHECK_EQ(cap.count, 1);
+    CHECK_EQ(cap.mismatches, 0);
+    CHECK_EQ(parser.stats.bytes_discarded, 2 * sizeof(noise));
+}
+
+static void test_random_noise(void)
+{
+    // Random bytes (headers included) between status frames; every frame
+    // must come out intact however the noise and the frames are chunked
+    const int frames = 200;
+    uint32_t seed = 0xC0FFEE;
+
+    capture_t cap = { .expect = golden_status, .expect_len = sizeof(golden_status) };
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    for (int f = 0; f < frames; f++) {
+        uint8_t noise[48];
+        seed = seed * 1103515245u + 12345u;
+        size_t noise_len = (seed >> 16) % sizeof(noise);
+        for (size_t i = 0; i < noise_len; i++) {
+            seed = seed * 1103515245u + 12345u;
+            noise[i] = (seed >> 16) & 1 ? HVAC_FRAME_HEADER_BYTE : seed >> 24;
+        }
+        hvac_frame_parser_feed(&parser, noise, noise_len);
+
+        seed = seed * 1103515245u + 12345u;
+        size_t split = (seed >> 16) % sizeof(golden_status);
+        hvac_frame_parser_feed(&parser, golden_status, split);
+        hvac_frame_parser_feed(&parser, &golden_status[split], sizeof(golden_status) - split);
+    }
+
+    CHECK_EQ(cap.count, frames);
+    CHECK_EQ(cap.mismatches, 0);
+    CHECK(parser.stats.bytes_discarded > 0);
+}
+
+static void test_high_water_bounded(void)
+{
+    // Every commit is parsed right away, so pending bytes never exceed one frame
+    capture_t cap = {0};
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    uint8_t noise[64];
+    memset(noise, 0x55, sizeof(noise));
+    for (int i = 0; i < 3 * HVAC_RX_RING_SIZE / (int)sizeof(noise); i++) {
+        hvac_frame_parser_feed(&parser, noise, sizeof(noise));
+    }
+    for (size_t i = 0; i < sizeof(golden_status); i++) {
+        hvac_frame_parser_feed(&parser, &golden_status[i], 1);
+    }
+
+    CHECK_EQ(cap.count, 1);
+    CHECK_EQ(parser.stats.overflows, 0);
+    CHECK(parser.stats.high_water <= sizeof(noise));
+}
+
+static void test_write_span_overflow(void)
+{
+    // Fill the ring through write spans without letting the parser consume
+    // anything (a reader that commits bytes the parser never reached)
+    capture_t cap = { .expect = golden_status, .expect_len = sizeof(golden_status) };
+    hvac_frame_parser_init(&parser, capture_handler, &cap);
+
+    // A partial frame is pending when the ring fills up
+    hvac_frame_parser_feed(&parser, golden_status, 10);
+    uint32_t pending = parser.head - parser.tail;
+    CHECK_EQ(pending, 10);
+
+    while (parser.head - parser.tail < HVAC_RX_RING_SIZE) {
+        uint8_t *dst;
+        size_t span = hvac_frame_parser_write_span(&parser, &dst);
+        size_t room = HVAC_RX_RING_SIZE - (parser.head - parser.tail);
+        CHECK(span > 0 && span <= room);
+        memset(dst, 0xEE, span);
+        parser.head += span;        // Written but not committed
+    }
+    CHECK_EQ(parser.stats.overflows, 0);
+
+    uint8_t *dst;
+    size_t span = hvac_frame_parser_write_span(&parser, &dst);
+    CHECK_EQ(parser.stats.overflows, 1);
+    CHECK_EQ(parser.stats.bytes_discarded, HVAC_RX_RING_SIZE);
+    CHECK_EQ(parser.head, parser.tail);
+    CHECK_EQ(parser.state, HVAC_PARSER_HUNT);
+    CHECK(span > 0);
+    CHECK(dst == &parser.ring[parser.head & HVAC_RX_RING_MASK]);
+
+    // The parser is usable again right away
+    hvac_frame_parser_feed(&parser, golden_status, sizeof(golden_status));
+    CHECK_EQ(cap.count, 1);
+    CHECK_EQ(cap.mismatches, 0);
+}
+
+int main(void)
+{
+    RUN(test_golden_frames);
+    RUN(test_unsupported_length);
+    RUN(test_resync_after_crc_error);
+    RUN(test_resync_header_inside_truncated_frame);
+    RUN(test_resync_double_header);
+    RUN(test_ring_wrap_around);
+    RUN(test_wrap_inside_crc);
+    RUN(test_fragmented_feeds);
+    RUN(test_fragmented_direct_spans);
+    RUN(test_garbage_before_header);
+    RUN(test_random_noise);
+    RUN(test_high_water_bounded);
+    RUN(test_write_span_overflow);
+    return TEST_RESULT();
+}
@@ -0,0 +1,148 @@
+/*
+ * Shadow tracker timelines: boot reconcile with lost control frames
+ *
+ * Replays the command task loop (poll every HVAC_SHADOW_POLL_MS while a
+ * request is pending) against an AC that drops the first N control frames
+ * and reports its unchanged state in between.
+ */
+
+#include "hvac_shadow_tracker.h"
+#include "hvac_test.h"
+
+#define FIELDS      0x00030005u     // A few power/mode/target bits, as a reconcile would set
+#define MS          1000LL
+
+typedef struct {
+    bool converged;
+    bool rolled_back;
+    int64_t done_us;                // When the request was confirmed or rolled back
+    int frames;                     // Control frames sent, the first one included
+} outcome_t;
+
+/**
+ * @brief Run a request to completion with the first lost_frames frames lost
+ */
+static outcome_t run_request(hvac_shadow_tracker_t *tracker, int lost_frames)
+{
+    outcome_t out = { .frames = 1 };
+    bool applied = lost_frames == 0;
+    int64_t now = 0;
+
+    if (!hvac_shadow_track_request(tracker, FIELDS, now)) {
+        out.converged = true;
+        return out;
+    }
+
+    while (now < 60000 * MS) {
+        now += HVAC_SHADOW_POLL_MS * MS;
+
+        // Status frame: the AC reports the request only once a frame got through
+        if (hvac_shadow_track_report(tracker, applied ? 0 : FIELDS)) {
+            out.converged = true;
+            out.done_us = now;
+            return out;
+        }
+
+        switch (hvac_shadow_track_poll(tracker, now)) {
+        case HVAC_SHADOW_RESEND:
+            out.frames++;
+            applied = out.frames > lost_frames;
+            break;
+        case HVAC_SHADOW_ROLLBACK:
+            out.rolled_back = true;
+            out.done_us = now;
+            return out;
+        case HVAC_SHADOW_WAIT:
+            break;
+        }
+    }
+    return out;
+}
+
+static void test_lost_reconcile_frame_is_retried(void)
+{
+    hvac_shadow_tracker_t tracker = {0};
+    outcome_t out = run_request(&tracker, 1);
+
+    CHECK(out.converged);
+    CHECK(!out.rolled_back);
+    CHECK_EQ(out.frames, 2);
+    CHECK_EQ(tracker.resends, 1);
+    CHECK_EQ(tracker.converged, 1);
+    CHECK_EQ(tracker.pending, 0);
+    // Re-sent at the first poll past the resend window, confirmed one poll later
+    CHECK_EQ(out.done_us, (HVAC_SHADOW_RESEND_MS + HVAC_SHADOW_POLL_MS) * MS);
+}
+
+static void test_every_frame_lost_rolls_back(void)
+{
+    hvac_shadow_tracker_t tracker = {0};
+    outcome_t out = run_request(&tracker, HVAC_SHADOW_MAX_ATTEMPTS);
+
+    CHECK(!out.converged);
+    CHECK(out.rolled_back);
+    CHECK_EQ(out.frames, HVAC_SHADOW_MAX_ATTEMPTS);
+    CHECK_EQ(tracker.resends, HVAC_SHADOW_MAX_ATTEMPTS - 1);
+    CHECK_EQ(tracker.rollbacks, 1);
+    CHECK_EQ(tracker.pending, 0);
+    CHECK_EQ(out.done_us, (int64_t)HVAC_SHADOW_MAX_ATTEMPTS * HVAC_SHADOW_RESEND_MS * MS);
+
+    // Nothing left to do after the rollback
+    CHECK_EQ(hvac_shadow_track_poll(&tracker, out.done_us + 10000 * MS), HVAC_SHADOW_WAIT);
+}
+
+static void test_last_attempt_gets_through(void)
+{
+    hvac_shadow_tracker_t tracker = {0};
+    outcome_t out = run_request(&tracker, HVAC_SHADOW_MAX_ATTEMPTS - 1);
+
+    CHECK(out.converged);
+    CHECK_EQ(out.frames, HVAC_SHADOW_MAX_ATTEMPTS);
+    CHECK_EQ(tracker.rollbacks, 0);
+}
+
+static void test_already_matching(void)
+{
+    // Reconcile found the AC already at the persisted settings: nothing to track
+    hvac_shadow_tracker_t tracker = {0};
+
+    CHECK(!hvac_shadow_track_request(&tracker, 0, 0));
+    CHECK(!hvac_shadow_track_report(&tracker, FIELDS));
+    CHECK_EQ(hvac_shadow_track_poll(&tracker, 10000 * MS), HVAC_SHADOW_WAIT);
+    CHECK_EQ(tracker.converged, 0);
+}
+
+static void test_partial_convergence(void)
+{
+    // A field the AC confirms stays confirmed; only the rest is re-sent
+    hvac_shadow_tracker_t tracker = {0};
+
+    CHECK(hvac_shadow_track_request(&tracker, FIELDS, 0));
+    CHECK(!hvac_shadow_track_report(&tracker, FIELDS & ~1u));
+    CHECK_EQ(tracker.pending, FIELDS & ~1u);
+    CHECK(!hvac_shadow_track_report(&tracker, FIELDS));
+    CHECK_EQ(tracker.pending, FIELDS & ~1u);
+    CHECK(hvac_shadow_track_report(&tracker, 0));
+}
+
+static void test_new_request_restarts_timer(void)
+{
+    hvac_shadow_tracker_t tracker = {0};
+
+    CHECK(hvac_shadow_track_request(&tracker, FIELDS, 0));
+    CHECK(hvac_shadow_track_request(&tracker, FIELDS, 1400 * MS));
+    CHECK_EQ(hvac_shadow_track_poll(&tracker, 1500 * MS), HVAC_SHADOW_WAIT);
+    CHECK_EQ(hvac_shadow_track_poll(&tracker, (1400 + HVAC_SHADOW_RESEND_MS) * MS), HVAC_SHADOW_RESEND);
+    CHECK_EQ(tracker.attempts, 2);
+}
+
+int main(void)
+{
+    RUN(test_lost_reconcile_frame_is_retried);
+    RUN(test_every_frame_lost_rolls_back);
+    RUN(test_last_attempt_gets_through);
+    RUN(test_already_matching);
+    RUN(test_partial_convergence);
+    RUN(test_new_request_restarts_timer);
+    return TEST_RESULT();
+}